@@ -1,430 +1,50 @@
-#include <iostream> // For input/output operations
-#include <string>   // For string manipulation
-#include <vector>   // For dynamic arrays (transaction history)
-#include <map>      // For key-value pairs (customers, accounts)
-#include <memory>   // For smart pointers (shared_ptr for memory management)
-#include <stdexcept> // For standard exceptions (e.g., ValueError)
-#include <iomanip>  // For output formatting (e.g., setprecision)
-#include <chrono>   // For date and time
-#include <ctime>    // For time_t and tm structures
-#include <sstream>  // For string stream operations
-
-// Use the std namespace as requested
-using namespace std;
-
-// --- Forward Declarations ---
-// Forward declarations are needed because Bank and Customer classes
-// will refer to each other or to Account before their full definitions.
-class Account;
-class SavingsAccount;
-class CheckingAccount;
-class Customer;
-class Bank;
-
-// --- Helper Function for Current Time (for Transaction History) ---
-string getCurrentDateTime() {
-    auto now = chrono::system_clock::now();
-    time_t now_time = chrono::system_clock::to_time_t(now);
-    tm* local_tm = localtime(&now_time); // Use localtime for local time
-
-    stringstream ss;
-    ss << put_time(local_tm, "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+#include "bank.h"     // Bank, Customer and Account core (the bank library)
+#include "workload.h" // Workload generation and replay
+
+// --- Workload Commands ---
+
+// Handles `--workload generate <file> [operations] [seed]` and `--workload replay <file>`.
+int runWorkloadCommand(int argc, char* argv[]) {
+    string command = argc > 2 ? argv[2] : "";
+    if (command == "generate" && argc > 3) {
+        WorkloadConfig config;
+        if (argc > 4) config.operations = stoull(argv[4]);
+        if (argc > 5) config.seed = stoull(argv[5]);
+        ofstream out(argv[3]);
+        if (!out) {
+            cout << "Error: Cannot write " << argv[3] << "." << endl;
+            return 1;
+        }
+        Workload workload = generateWorkload(config);
+        saveWorkload(out, workload);
+        cout << "Wrote " << workload.ops.size() << " operations to " << argv[3] << "." << endl;
+        return 0;
+    }
+    if (command == "replay" && argc > 3) {
+        ifstream in(argv[3]);
+        Workload workload;
+        if (!in || !loadWorkload(in, workload)) {
+            cout << "Error: Cannot read workload " << argv[3] << "." << endl;
+            return 1;
+        }
+        Bank bank("Replay Bank");
+        ReplayResult result = replayWorkload(bank, workload);
+        cout << fixed << "Replayed " << workload.ops.size() << " operations: " << result.applied << " applied, "
+                  << result.rejected << " rejected in " << setprecision(3) << result.seconds << " s. Fingerprint "
+                  << hex << result.fingerprint << dec << endl;
+        return 0;
+    }
+    cout << "Usage: --workload generate <file> [operations] [seed] | --workload replay <file>" << endl;
+    return 1;
 }
 
-// --- DSA: Transaction Struct ---
-// Represents a single transaction record.
-struct Transaction {
-    string type;
-    double amount;
-    string date;
-    double newBalance;
-
-    // Constructor for easy initialization
-    Transaction(string type, double amount, double newBalance)
-        : type(type), amount(amount), date(getCurrentDateTime()), newBalance(newBalance) {}
-
-    // Method to print transaction details
-    void print() const {
-        cout << "  - " << date << " | Type: " << type
-                  << " | Amount: $" << fixed << setprecision(2) << amount
-                  << " | New Balance: $" << newBalance << endl;
-    }
-};
-
-// --- OOP Classes ---
-
-// Base class for all bank accounts.
-// Demonstrates encapsulation and common attributes.
-class Account {
-protected: // Protected members are accessible by derived classes
-    string _accountNumber;
-    string _ownerName;
-    double _balance;
-    vector<Transaction> _transactions; // DSA: Vector to store transaction history
-
-public:
-    // Constructor
-    Account(const string& accountNumber, const string& ownerName, double initialBalance = 0.0)
-        : _accountNumber(accountNumber), _ownerName(ownerName), _balance(initialBalance) {
-        if (accountNumber.empty()) {
-            throw invalid_argument("Account number cannot be empty.");
-        }
-        if (ownerName.empty()) {
-            throw invalid_argument("Owner name cannot be empty.");
-        }
-        if (initialBalance < 0) {
-            throw invalid_argument("Initial balance cannot be negative.");
-        }
-    }
-
-    // Virtual destructor to ensure proper cleanup of derived classes
-    virtual ~Account() = default;
-
-    // Getter methods
-    string getAccountNumber() const { return _accountNumber; }
-    string getOwnerName() const { return _ownerName; }
-    double getBalance() const { return _balance; }
-
-    // Deposits money into the account.
-    // Adds a transaction record.
-    bool deposit(double amount) {
-        if (amount <= 0) {
-            cout << "Deposit amount must be a positive number." << endl;
-            return false;
-        }
-        _balance += amount;
-        _transactions.emplace_back("Deposit", amount, _balance); // Add transaction
-        cout << "Deposited $" << fixed << setprecision(2) << amount
-                  << " into account " << _accountNumber << ". New balance: $" << _balance << endl;
-        return true;
-    }
-
-    // Withdraws money from the account.
-    // Checks for sufficient funds. Adds a transaction record.
-    // This method is virtual to allow overriding in subclasses for specific rules (Polymorphism).
-    virtual bool withdraw(double amount) {
-        if (amount <= 0) {
-            cout << "Withdrawal amount must be a positive number." << endl;
-            return false;
-        }
-        if (_balance < amount) {
-            cout << "Insufficient funds. Current balance: $" << fixed << setprecision(2) << _balance
-                      << ". Attempted withdrawal: $" << amount << endl;
-            return false;
-        }
-        _balance -= amount;
-        _transactions.emplace_back("Withdrawal", amount, _balance); // Add transaction
-        cout << "Withdrew $" << fixed << setprecision(2) << amount
-                  << " from account " << _accountNumber << ". New balance: $" << _balance << endl;
-        return true;
-    }
-
-    // Returns the list of transactions for this account.
-    const vector<Transaction>& getTransactionHistory() const {
-        return _transactions;
-    }
-
-    // Virtual method to print account details (Polymorphism)
-    virtual void printDetails() const {
-        cout << "Account Number: " << _accountNumber
-                  << ", Owner: " << _ownerName
-                  << ", Balance: $" << fixed << setprecision(2) << _balance;
-    }
-};
-
-// Represents a savings account with an interest rate.
-// Inherits from Account.
-class SavingsAccount : public Account {
-private:
-    double _interestRate;
-
-public:
-    // Constructor
-    SavingsAccount(const string& accountNumber, const string& ownerName,
-                   double initialBalance = 0.0, double interestRate = 0.01)
-        : Account(accountNumber, ownerName, initialBalance), _interestRate(interestRate) {
-        if (interestRate < 0 || interestRate > 1) {
-            throw invalid_argument("Interest rate must be between 0 and 1 (e.g., 0.01 for 1%).");
-        }
-    }
-
-    // Applies interest to the account balance.
-    void applyInterest() {
-        double interestAmount = _balance * _interestRate;
-        _balance += interestAmount;
-        _transactions.emplace_back("Interest Applied", interestAmount, _balance); // Add transaction
-        cout << "Interest of $" << fixed << setprecision(2) << interestAmount
-                  << " applied to savings account " << _accountNumber << ". "
-                  << "New balance: $" << _balance << endl;
-    }
-
-    // Overrides the printDetails method for SavingsAccount specific information.
-    void printDetails() const override {
-        cout << "Savings Account Number: " << _accountNumber
-                  << ", Owner: " << _ownerName
-                  << ", Balance: $" << fixed << setprecision(2) << _balance
-                  << ", Interest Rate: " << _interestRate * 100 << "%";
-    }
-};
-
-// Represents a checking account with an optional overdraft limit.
-// Inherits from Account.
-class CheckingAccount : public Account {
-private:
-    double _overdraftLimit;
-
-public:
-    // Constructor
-    CheckingAccount(const string& accountNumber, const string& ownerName,
-                    double initialBalance = 0.0, double overdraftLimit = 0.0)
-        : Account(accountNumber, ownerName, initialBalance), _overdraftLimit(overdraftLimit) {
-        if (overdraftLimit < 0) {
-            throw invalid_argument("Overdraft limit cannot be negative.");
-        }
-    }
-
-    // Overrides the withdraw method to include overdraft logic (Polymorphism).
-    bool withdraw(double amount) override {
-        if (amount <= 0) {
-            cout << "Withdrawal amount must be a positive number." << endl;
-            return false;
-        }
-
-        if (_balance + _overdraftLimit < amount) {
-            cout << "Withdrawal denied. Exceeds overdraft limit of $" << fixed << setprecision(2) << _overdraftLimit
-                      << ". Current balance: $" << _balance << ". Attempted withdrawal: $" << amount << endl;
-            return false;
-        }
-
-        _balance -= amount;
-        _transactions.emplace_back("Withdrawal", amount, _balance); // Add transaction
-        cout << "Withdrew $" << fixed << setprecision(2) << amount
-                  << " from checking account " << _accountNumber << ". New balance: $" << _balance << endl;
-        return true;
-    }
-
-    // Overrides the printDetails method for CheckingAccount specific information.
-    void printDetails() const override {
-        cout << "Checking Account Number: " << _accountNumber
-                  << ", Owner: " << _ownerName
-                  << ", Balance: $" << fixed << setprecision(2) << _balance
-                  << ", Overdraft Limit: $" << _overdraftLimit;
-    }
-};
-
-// Represents a bank customer, holding their accounts.
-class Customer {
-private:
-    string _customerId;
-    string _name;
-    string _address;
-    // DSA: Map to store accounts by account number. Using shared_ptr for memory management.
-    map<string, shared_ptr<Account>> _accounts;
-
-public:
-    // Constructor
-    Customer(const string& customerId, const string& name, const string& address)
-        : _customerId(customerId), _name(name), _address(address) {
-        if (customerId.empty()) {
-            throw invalid_argument("Customer ID cannot be empty.");
-        }
-        if (name.empty()) {
-            throw invalid_argument("Customer name cannot be empty.");
-        }
-        if (address.empty()) {
-            throw invalid_argument("Address cannot be empty.");
-        }
-    }
-
-    // Getter methods
-    string getCustomerId() const { return _customerId; }
-    string getName() const { return _name; }
-    string getAddress() const { return _address; }
-
-    // Adds an account to the customer's portfolio.
-    void addAccount(shared_ptr<Account> account) {
-        if (!account) {
-            throw invalid_argument("Account pointer cannot be null.");
-        }
-        _accounts[account->getAccountNumber()] = account; // DSA: Map insertion O(log N)
-        cout << "Account " << account->getAccountNumber() << " added for customer " << _name << "." << endl;
-    }
-
-    // Retrieves an account by its number (DSA: Map lookup O(log N)).
-    shared_ptr<Account> getAccount(const string& accountNumber) const {
-        auto it = _accounts.find(accountNumber);
-        if (it != _accounts.end()) {
-            return it->second;
-        }
-        return nullptr; // Account not found
-    }
-
-    // Returns a vector of all accounts for this customer.
-    vector<shared_ptr<Account>> getAllAccounts() const {
-        vector<shared_ptr<Account>> allCustomerAccounts;
-        for (const auto& pair : _accounts) {
-            allCustomerAccounts.push_back(pair.second);
-        }
-        return allCustomerAccounts;
-    }
-
-    // Prints customer details.
-    void printDetails() const {
-        cout << "Customer ID: " << _customerId
-                  << ", Name: " << _name
-                  << ", Address: " << _address
-                  << ", Accounts: " << _accounts.size();
-    }
-};
-
-// Manages all customers and accounts in the banking system.
-// Uses dictionaries (maps) for efficient storage and retrieval.
-class Bank {
-private:
-    string _name;
-    // DSA: Map to store customers by customer_id. Using shared_ptr for memory management.
-    map<string, shared_ptr<Customer>> _customers;
-    // DSA: Map to store all accounts by account_number. Using shared_ptr for memory management.
-    map<string, shared_ptr<Account>> _accounts;
-
-    // Simple counter for generating unique IDs (for demonstration)
-    long long _nextCustomerId = 1000;
-    long long _nextAccountNumber = 100000;
-
-public:
-    // Constructor
-    Bank(const string& name) : _name(name) {}
-
-    // Public getter for the bank's name
-    string getName() const { return _name; }
-
-    // Creates and adds a new customer to the bank.
-    shared_ptr<Customer> addCustomer(const string& name, const string& address) {
-        string customerId = "C" + to_string(_nextCustomerId++); // Generate unique ID
-        auto customer = make_shared<Customer>(customerId, name, address);
-        _customers[customerId] = customer; // DSA: Map insertion O(log N)
-        cout << "Customer '" << name << "' added with ID: " << customerId << endl;
-        return customer;
-    }
-
-    // Retrieves a customer by their ID (DSA: Map lookup O(log N)).
-    shared_ptr<Customer> getCustomer(const string& customerId) const {
-        auto it = _customers.find(customerId);
-        if (it != _customers.end()) {
-            return it->second;
-        }
-        return nullptr; // Customer not found
-    }
-
-    // Creates a new account (Savings or Checking) for a given customer.
-    shared_ptr<Account> createAccount(const string& customerId, const string& accountType,
-                                           double initialBalance = 0.0,
-                                           double interestRate = 0.01, double overdraftLimit = 0.0) {
-        shared_ptr<Customer> customer = getCustomer(customerId);
-        if (!customer) {
-            cout << "Error: Customer with ID " << customerId << " not found." << endl;
-            return nullptr;
-        }
-
-        string accountNumber = "ACC" + to_string(_nextAccountNumber++); // Generate unique account number
-        shared_ptr<Account> account = nullptr;
-
-        if (accountType == "savings") {
-            account = make_shared<SavingsAccount>(accountNumber, customer->getName(), initialBalance, interestRate);
-        } else if (accountType == "checking") {
-            account = make_shared<CheckingAccount>(accountNumber, customer->getName(), initialBalance, overdraftLimit);
-        } else {
-            cout << "Invalid account type. Choose 'savings' or 'checking'." << endl;
-            return nullptr;
-        }
-
-        customer->addAccount(account);
-        _accounts[accountNumber] = account; // DSA: Map insertion O(log N)
-        cout << "Successfully created a " << accountType << " account for " << customer->getName()
-                  << " (ID: " << customerId << "). Account Number: " << accountNumber << endl;
-        return account;
-    }
-
-    // Retrieves an account by its number (DSA: Map lookup O(log N)).
-    shared_ptr<Account> getAccount(const string& accountNumber) const {
-        auto it = _accounts.find(accountNumber);
-        if (it != _accounts.end()) {
-            return it->second;
-        }
-        return nullptr; // Account not found
-    }
-
-    // Transfers funds between two accounts.
-    bool transferFunds(const string& fromAccountNum, const string& toAccountNum, double amount) {
-        shared_ptr<Account> fromAccount = getAccount(fromAccountNum);
-        shared_ptr<Account> toAccount = getAccount(toAccountNum);
-
-        if (!fromAccount) {
-            cout << "Error: Source account " << fromAccountNum << " not found." << endl;
-            return false;
-        }
-        if (!toAccount) {
-            cout << "Error: Destination account " << toAccountNum << " not found." << endl;
-            return false;
-        }
-        if (fromAccountNum == toAccountNum) {
-            cout << "Error: Cannot transfer to the same account." << endl;
-            return false;
-        }
-        if (amount <= 0) {
-            cout << "Transfer amount must be a positive number." << endl;
-            return false;
-        }
-
-        if (fromAccount->withdraw(amount)) { // Use the virtual withdraw method
-            toAccount->deposit(amount);      // Use the deposit method
-            cout << "Successfully transferred $" << fixed << setprecision(2) << amount
-                      << " from " << fromAccountNum << " to " << toAccountNum << "." << endl;
-            return true;
-        } else {
-            cout << "Transfer failed due to insufficient funds or other withdrawal error." << endl;
-            return false;
-        }
-    }
-
-    // Displays details of all customers.
-    void displayAllCustomers() const {
-        if (_customers.empty()) {
-            cout << "No customers in the bank yet." << endl;
-            return;
-        }
-        cout << "\n--- All Customers ---" << endl;
-        for (const auto& pair : _customers) {
-            pair.second->printDetails();
-            cout << endl;
-            for (const auto& account : pair.second->getAllAccounts()) {
-                cout << "  - ";
-                account->printDetails();
-                cout << endl;
-            }
-        }
-        cout << "---------------------\n" << endl;
-    }
+// --- Simulation / Usage Example ---
 
-    // Displays details of all accounts.
-    void displayAllAccounts() const {
-        if (_accounts.empty()) {
-            cout << "No accounts in the bank yet." << endl;
-            return;
-        }
-        cout << "\n--- All Accounts ---" << endl;
-        for (const auto& pair : _accounts) {
-            pair.second->printDetails();
-            cout << endl;
-        }
-        cout << "--------------------\n" << endl;
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && string(argv[1]) == "--workload") {
+        return runWorkloadCommand(argc, argv);
     }
-};
-
-// --- Simulation / Usage Example ---
 
-int main() {
     // Set output precision for currency
     cout << fixed << setprecision(2);
 
@@ -489,6 +109,141 @@ int main() {
         myBank.transferFunds(acc2_checking->getAccountNumber(), acc1_savings->getAccountNumber(), 10000.0);
     }
 
+    // --- Account Lifecycle ---
+    cout << "\n--- Account Lifecycle ---" << endl;
+    if (acc2_checking) {
+        myBank.freezeAccount(acc2_checking->getAccountNumber());
+        acc2_checking->deposit(50.0); // Should fail (account frozen)
+        myBank.unfreezeAccount(acc2_checking->getAccountNumber());
+    }
+    shared_ptr<Customer> customer3 = myBank.addCustomer("Carol White", "789 Pine Rd, Smallville");
+    shared_ptr<Account> acc3_checking = myBank.createAccount(customer3->getCustomerId(), "checking", 40.0);
+    if (acc3_checking) {
+        myBank.closeAccount(customer3->getCustomerId(), acc3_checking->getAccountNumber()); // Should fail (non-zero balance)
+        acc3_checking->withdraw(40.0);
+        myBank.closeAccount(customer3->getCustomerId(), acc3_checking->getAccountNumber());
+    }
+    myBank.removeCustomer(customer3->getCustomerId());
+
+    // --- Joint Accounts ---
+    cout << "\n--- Joint Accounts ---" << endl;
+    if (acc1_savings) {
+        myBank.addJointOwner(acc1_savings->getAccountNumber(), customer2->getCustomerId());
+        myBank.addJointOwner(acc1_savings->getAccountNumber(), customer2->getCustomerId()); // Should fail (already an owner)
+        cout << "Owners of " << acc1_savings->getAccountNumber() << ":";
+        for (const string& ownerId : myBank.getAccountOwnerIds(acc1_savings->getAccountNumber())) {
+            cout << " " << ownerId;
+        }
+        cout << endl;
+        cout << "Bob now holds " << customer2->getAccountCount() << " accounts." << endl;
+    }
+
+    // --- Multi-Currency ---
+    cout << "\n--- Multi-Currency Transfers ---" << endl;
+    myBank.setExchangeRate(Currency::EUR, 1.08);
+    myBank.setExchangeRate(Currency::GBP, 1.27);
+    shared_ptr<Account> acc2_euro = myBank.createAccount(customer2->getCustomerId(), "savings", 0.0, 0.02, 0.0, Currency::EUR);
+    if (acc2_euro && acc2_savings) {
+        myBank.transferFunds(acc2_savings->getAccountNumber(), acc2_euro->getAccountNumber(), 540.0);
+        myBank.transferBatch({
+            {acc2_euro->getAccountNumber(), acc2_savings->getAccountNumber(), 100.0},
+            {acc2_savings->getAccountNumber(), acc2_euro->getAccountNumber(), 216.0},
+        });
+        double total = 0.0;
+        if (myBank.totalBalances(Currency::USD, total)) {
+            cout << "Total deposits in USD: $" << total << endl;
+        }
+    }
+
+    // --- Money-Flow Tracing ---
+    cout << "\n--- Money-Flow Trace (3 hops) ---" << endl;
+    if (acc2_savings) {
+        for (const FlowHop& hop : myBank.traceFunds(acc2_savings->getAccountNumber(), 3, 0, time(nullptr))) {
+            cout << "  Hop " << hop.hops << ": " << hop.accountNumber << " via transfer #" << hop.transferId
+                 << " (credited " << fixed << setprecision(2) << hop.amount << ")" << endl;
+        }
+    }
+
+    // --- Anomaly Detection ---
+    cout << "\n--- Unusual Activity ---" << endl;
+    CheckingAccount payroll("PAY-DEMO", customer2->getName(), 0.0); // Standalone, outside the bank
+    for (int week = 0; week < 40; ++week) {
+        payroll.postDeposit(week % 2 ? 1240.0 : 1260.0); // Regular pay, posted quietly
+    }
+    payroll.deposit(1255.0); // Usual: not flagged
+    payroll.deposit(9800.0); // Far outside the usual deposits: flagged
+    cout << "Deposits average $" << payroll.getDepositStats().mean << "; " << payroll.getAnomalyCount()
+         << " posting(s) flagged." << endl;
+
+    // --- Rate Limiting ---
+    cout << "\n--- Rate Limiting ---" << endl;
+    myBank.configureRateLimits({1.0, 3.0}, {}); // One request per second per account, in bursts of up to 3
+    if (acc2_checking) {
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            myBank.deposit(acc2_checking->getAccountNumber(), 5.0); // The fourth is rejected
+        }
+    }
+    myBank.configureRateLimits({}, {});
+
+    // --- Interest Engine ---
+    cout << "\n--- Monthly Interest (daily compounding, Actual/365F) ---" << endl;
+    int today = currentDayNumber();
+    myBank.accrueInterest(DailyCompoundPolicy<Actual365Fixed>(), AccrualPeriod{today - 30, today});
+
+    // --- Lazy Interest Accrual ---
+    cout << "\n--- Lazy Interest Accrual ---" << endl;
+    myBank.advanceBusinessDays(30); // No per-account work happens here
+    if (acc1_savings) {
+        cout << "Alice's Savings balance with accrued interest: $" << acc1_savings->getBalance() << endl;
+        myBank.printStatement(acc1_savings->getAccountNumber());
+    }
+
+    // --- Authorization Holds ---
+    cout << "\n--- Card Authorization Holds ---" << endl;
+    if (acc2_checking && acc1_savings) {
+        uint64_t dinner = myBank.authorizeHold(acc2_checking->getAccountNumber(), 250.0);
+        myBank.authorizeHold(acc2_checking->getAccountNumber(), 400.0); // Should fail (held funds count against the overdraft)
+        myBank.captureHold(dinner, 212.50); // Final amount lower than authorized; the rest is released
+        myBank.authorizeHold(acc2_checking->getAccountNumber(), 50.0, 3); // Never captured
+        uint64_t hotel = myBank.authorizeHold(acc1_savings->getAccountNumber(), 300.0);
+        myBank.releaseHold(hotel);
+        acc2_checking->printDetails();
+        cout << endl;
+        myBank.advanceBusinessDays(3); // The uncaptured hold expires
+    }
+
+    // --- ACH Cutoff ---
+    cout << "\n--- ACH Cutoff ---" << endl;
+    if (acc1_checking && acc2_savings) {
+        myBank.queueAchCredit(acc1_checking->getAccountNumber(), 1500.0); // Payroll
+        myBank.queueAchDebit(acc1_checking->getAccountNumber(), 320.0);   // Utility bill
+        myBank.queueAchDebit(acc2_savings->getAccountNumber(), 25000.0);  // Should be returned
+        acc1_checking->printDetails();
+        cout << endl;
+        myBank.closeAccount(customer1->getCustomerId(), acc1_checking->getAccountNumber()); // Should fail (pending items)
+        myBank.runAchCutoff();
+        acc1_checking->printDetails();
+        cout << endl;
+    }
+
+    // --- Bulk Jobs ---
+    cout << "\n--- Bulk Jobs ---" << endl;
+    myBank.configureWorkers(2);
+    stringstream imported("customer_id,type,initial_balance,currency\n"
+                          + customer2->getCustomerId() + ",savings,250.00,GBP\n"
+                          + customer2->getCustomerId() + ",checking,not-a-number\n");
+    myBank.importAccounts(imported);
+    if (acc1_checking && acc1_savings && acc2_checking && acc2_savings) {
+        myBank.transferBatchParallel({
+            {acc1_checking->getAccountNumber(), acc2_checking->getAccountNumber(), 20.0},
+            {acc2_savings->getAccountNumber(), acc1_savings->getAccountNumber(), 75.0}, // Independent of the first
+            {acc2_checking->getAccountNumber(), acc2_savings->getAccountNumber(), 5000.0}, // Waits for the first
+        });
+    }
+    myBank.reconcileAccounts();
+    myBank.exportAccounts(cout);
+    myBank.printJobStats();
+
     // Display final state
     myBank.displayAllCustomers();
     myBank.displayAllAccounts();
@@ -0,0 +1,1475 @@
+#include "bank.h"
+#include "workload.h"
+#include "replication.h"
+
+#include <poll.h>     // For checking the standby control pipe
+#include <sys/socket.h> // For the balance round-trip baseline
+#include <sys/wait.h> // For waiting on the standby and reader processes
+
+// --- Benchmarks ---
+// Run with: ./bank_bench <name> [size]. Each benchmark prints one line per variant.
+
+// Times `passes` accrual passes of one policy over a copy of the balances.
+template <class Policy>
+void benchAccrualPolicy(Policy policy, const vector<double>& initialBalances,
+                        const vector<double>& rates, int passes) {
+    vector<double> balances = initialBalances;
+    vector<double> interest(balances.size());
+    AccrualPeriod period{daysFromCivil(2024, 1, 1), daysFromCivil(2024, 1, 2)};
+    policy.prepare(period);
+    double seconds = timeSeconds([&] {
+        for (int pass = 0; pass < passes; ++pass) {
+            accrueInterestKernel(policy, balances.data(), rates.data(), interest.data(), balances.size());
+        }
+    });
+    double perAccount = seconds * 1e9 / (static_cast<double>(balances.size()) * passes);
+    double checksum = 0.0;
+    for (double b : balances) {
+        checksum += b;
+    }
+    cout << left << setw(32) << Policy::name() << right
+              << setw(10) << setprecision(3) << perAccount << " ns/account  "
+              << setw(10) << setprecision(1) << 1e-6 / (perAccount * 1e-9) << " M accounts/s"
+              << "  (checksum " << setprecision(2) << checksum << ")" << endl;
+}
+
+// Accrual pass over `accounts` synthetic savings balances, once per policy.
+int runAccrualBenchmark(size_t accounts) {
+    mt19937_64 rng(42);
+    lognormal_distribution<double> balanceDist(8.0, 1.5);
+    uniform_real_distribution<double> rateDist(0.0, 0.05);
+    vector<double> balances(accounts), rates(accounts);
+    for (size_t i = 0; i < accounts; ++i) {
+        balances[i] = balanceDist(rng);
+        rates[i] = rateDist(rng);
+    }
+    const int passes = 5;
+    const array<InterestTier, 3> tiers{{{0.0, 0.005}, {10000.0, 0.015}, {100000.0, 0.025}}};
+    cout << "Accrual pass over " << accounts << " accounts, " << passes << " passes per policy" << endl;
+    benchAccrualPolicy(SimpleInterestPolicy<Actual365Fixed>(), balances, rates, passes);
+    benchAccrualPolicy(SimpleInterestPolicy<Thirty360>(), balances, rates, passes);
+    benchAccrualPolicy(DailyCompoundPolicy<Actual365Fixed>(), balances, rates, passes);
+    benchAccrualPolicy(DailyCompoundPolicy<Actual360>(), balances, rates, passes);
+    benchAccrualPolicy(TieredRatePolicy<Actual365Fixed, 3>(tiers), balances, rates, passes);
+    return 0;
+}
+
+// Replays a recorded workload (see `bank1 --workload generate`) on the console Bank and
+// on the silent profile. Both must end in the same state. Also the PGO training run
+// (scripts/pgo_build.sh), so it goes through the same code as the other benchmarks.
+int runRecordedWorkloadBenchmark(const string& path) {
+    ifstream in(path);
+    Workload workload;
+    if (!in || !loadWorkload(in, workload)) {
+        cout << "Error: Cannot read workload " << path << "." << endl;
+        return 1;
+    }
+    Bank bank("Recorded Workload Bank");
+    BasicBank<SingleThreaded, InMemory, NoInstrumentation, SilentLog> silent("Recorded Workload Bank");
+    ReplayResult console = replayWorkload(bank, workload);
+    ReplayResult quiet = replayWorkload(silent, workload);
+    cout << "Replayed " << workload.ops.size() << " recorded operations: console " << setprecision(3)
+              << console.seconds << " s, silent " << quiet.seconds << " s; state "
+              << (console.fingerprint == quiet.fingerprint ? "matches" : "DIFFERS") << endl;
+    return console.fingerprint == quiet.fingerprint ? 0 : 1;
+}
+
+// Generates a seeded workload and replays it twice on fresh banks. Both runs must end in
+// the same state; the second run's time is reported.
+int runReplayBenchmark(size_t operations) {
+    WorkloadConfig config;
+    config.operations = operations;
+    config.customers = 10000;
+    Workload workload = generateWorkload(config);
+    ReplayResult results[2];
+    for (ReplayResult& result : results) {
+        Bank bank("Replay Bank");
+        result = replayWorkload(bank, workload);
+    }
+    cout << "Replayed " << workload.ops.size() << " operations (seed " << config.seed << ", zipf "
+              << setprecision(2) << config.zipfSkew << "): " << results[1].applied << " applied, "
+              << results[1].rejected << " rejected, " << setprecision(3) << results[1].seconds << " s, "
+              << setprecision(0) << workload.ops.size() / results[1].seconds << " ops/s" << endl;
+    cout << "Fingerprint " << hex << results[1].fingerprint << dec
+              << (results[0].fingerprint == results[1].fingerprint ? " (deterministic)" : " (MISMATCH)") << endl;
+    return results[0].fingerprint == results[1].fingerprint ? 0 : 1;
+}
+
+// Counts of account accesses that hit memory on the accessing worker's node or another.
+struct NumaAccessStats {
+    uint64_t local = 0;
+    uint64_t remote = 0;
+    double seconds = 0.0;
+};
+
+// Runs `depositsPerAccount` deposits on every account, each on its owning shard's worker,
+// and classifies every access as node-local or remote. Real NUMA machines ask the
+// kernel which node backs the account; emulated nodes use the node the account was
+// created on (unpinned threads count as node 0).
+NumaAccessStats runShardDeposits(ShardRuntime& shards, const Bank& bank, int depositsPerAccount) {
+    const bool emulated = shards.getTopology().emulated;
+    vector<vector<Account*>> owned(shards.shardCount());
+    for (const auto& account : bank.getAllAccounts()) {
+        owned[shards.shardFor(account->getAccountNumber())].push_back(account.get());
+    }
+    vector<NumaAccessStats> perShard(shards.shardCount());
+    NumaAccessStats total;
+    total.seconds = timeSeconds([&] {
+        for (size_t s = 0; s < shards.shardCount(); ++s) {
+            shards.submit(s, [&, s] {
+                const int workerNode = shards.nodeOfShard(s);
+                for (Account* account : owned[s]) {
+                    int accountNode = emulated ? max(account->getHomeNode(), 0) : nodeOfAddress(account);
+                    for (int i = 0; i < depositsPerAccount; ++i) {
+                        account->postDeposit(1.0);
+                    }
+                    (accountNode == workerNode ? perShard[s].local : perShard[s].remote) += depositsPerAccount;
+                }
+            });
+        }
+        shards.drain();
+    });
+    for (const NumaAccessStats& stats : perShard) {
+        total.local += stats.local;
+        total.remote += stats.remote;
+    }
+    return total;
+}
+
+// Opens `accounts` accounts with or without shard placement, then runs shard deposits.
+void benchNumaPlacement(const string& label, ShardRuntime& shards, size_t accounts, bool placed) {
+    Bank bank("NUMA Bank");
+    {
+        ScopedQuietOutput quiet;
+        if (placed) {
+            bank.attachShards(&shards);
+        }
+        string customerId = bank.addCustomer("NUMA Tester", "1 Socket Way")->getCustomerId();
+        for (size_t i = 0; i < accounts; ++i) {
+            bank.createAccount(customerId, "checking", 100.0);
+        }
+    }
+    const int depositsPerAccount = 20;
+    NumaAccessStats stats = runShardDeposits(shards, bank, depositsPerAccount);
+    uint64_t accesses = stats.local + stats.remote;
+    cout << left << setw(26) << label << right << "local " << setw(10) << stats.local << "  remote " << setw(10)
+              << stats.remote << "  local ratio " << setw(6) << setprecision(1) << 100.0 * stats.local / accesses
+              << "%  " << setprecision(2) << accesses / stats.seconds / 1e6 << " M deposits/s" << endl;
+}
+
+// Compares first-touch on the main thread against shard-placed accounts.
+int runNumaBenchmark(size_t accounts) {
+    NumaTopology topology = NumaTopology::detect();
+    cout << "NUMA nodes: " << topology.nodeCount() << (topology.emulated ? " (emulated)" : "") << endl;
+    for (size_t node = 0; node < topology.nodeCount(); ++node) {
+        cout << "  node " << node << ": " << topology.nodeCpus[node].size() << " cpu(s)" << endl;
+    }
+    ShardRuntime shards(topology, topology.nodeCount());
+    cout << accounts << " accounts, " << shards.shardCount() << " shard workers" << endl;
+    benchNumaPlacement("allocated by main thread", shards, accounts, false);
+    benchNumaPlacement("allocated by shard owner", shards, accounts, true);
+    return 0;
+}
+
+// Per-account hot state as it was laid out before accounts were cache-line aligned:
+// neighbouring accounts' balances, versions and locks share cache lines.
+struct PackedHotState {
+    double balance = 0.0;
+    uint64_t version = 0;
+    SpinLock lock;
+};
+
+// The same state isolated on its own cache line, as Account lays it out now.
+struct alignas(kCacheLineSize) IsolatedHotState {
+    double balance = 0.0;
+    uint64_t version = 0;
+    SpinLock lock;
+};
+
+// Runs `threads` threads that each post `depositsPerThread` locked deposits, round-robin
+// over their own slots. Thread t owns slots t, t + threads, t + 2 * threads, ..., so
+// neighbouring slots in memory always belong to different threads. Returns deposits/s.
+template <class Slot>
+double benchHotStateDeposits(size_t threads, size_t slotsPerThread, size_t depositsPerThread) {
+    vector<Slot> slots(threads * slotsPerThread);
+    atomic<bool> start{false};
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            while (!start.load(memory_order_acquire)) {
+                this_thread::yield();
+            }
+            for (size_t i = 0; i < depositsPerThread; ++i) {
+                Slot& slot = slots[t + (i % slotsPerThread) * threads];
+                lock_guard<SpinLock> guard(slot.lock);
+                slot.balance += 1.0;
+                ++slot.version;
+            }
+        });
+    }
+    auto begin = chrono::steady_clock::now();
+    start.store(true, memory_order_release);
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    return threads * depositsPerThread / seconds;
+}
+
+// Same access pattern against real Account objects using their lock and postDeposit.
+double benchAccountDeposits(size_t threads, size_t slotsPerThread, size_t depositsPerThread) {
+    Bank bank("Layout Bank");
+    vector<shared_ptr<Account>> accounts;
+    {
+        ScopedQuietOutput quiet;
+        string customerId = bank.addCustomer("Layout Tester", "64 Cache Line Rd")->getCustomerId();
+        for (size_t i = 0; i < threads * slotsPerThread; ++i) {
+            accounts.push_back(bank.createAccount(customerId, "checking", 0.0));
+            accounts.back()->reserveHistory(depositsPerThread / slotsPerThread + 1);
+        }
+    }
+    atomic<bool> start{false};
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            while (!start.load(memory_order_acquire)) {
+                this_thread::yield();
+            }
+            for (size_t i = 0; i < depositsPerThread; ++i) {
+                Account& account = *accounts[t + (i % slotsPerThread) * threads];
+                lock_guard<Account> guard(account);
+                account.postDeposit(1.0);
+            }
+        });
+    }
+    auto begin = chrono::steady_clock::now();
+    start.store(true, memory_order_release);
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    return threads * depositsPerThread / seconds;
+}
+
+// Multi-threaded deposits on adjacent accounts: packed vs cache-line isolated hot state.
+int runLayoutBenchmark(size_t depositsPerThread) {
+    const size_t threads = max(2u, thread::hardware_concurrency());
+    const size_t slotsPerThread = 64;
+    cout << threads << " threads, " << depositsPerThread << " deposits each, "
+              << slotsPerThread << " interleaved accounts per thread" << endl;
+    cout << "  packed hot state (before):   " << setprecision(2)
+              << benchHotStateDeposits<PackedHotState>(threads, slotsPerThread, depositsPerThread) / 1e6
+              << " M deposits/s (" << sizeof(PackedHotState) << " bytes/account)" << endl;
+    cout << "  isolated hot state (after):  "
+              << benchHotStateDeposits<IsolatedHotState>(threads, slotsPerThread, depositsPerThread) / 1e6
+              << " M deposits/s (" << sizeof(IsolatedHotState) << " bytes/account)" << endl;
+    cout << "  Account::postDeposit:        "
+              << benchAccountDeposits(threads, slotsPerThread, depositsPerThread) / 1e6
+              << " M deposits/s (" << sizeof(CheckingAccount) << " bytes/account)" << endl;
+    return 0;
+}
+
+// Resolves `accounts` random account numbers (about 1 in 16 unknown) against a bank of
+// `accounts` accounts: one getAccount call per key vs one batched findAccounts call.
+int runLookupBenchmark(size_t accounts) {
+    Bank bank("Lookup Bank");
+    vector<string> numbers;
+    numbers.reserve(accounts);
+    {
+        ScopedQuietOutput quiet;
+        bank.reserveAccounts(accounts);
+        string customerId;
+        for (size_t i = 0; i < accounts; ++i) {
+            if (i % 1000 == 0) {
+                customerId = bank.addCustomer("Lookup Tester", "1 Hash Way")->getCustomerId();
+            }
+            numbers.push_back(bank.createAccount(customerId, "checking", 0.0)->getAccountNumber());
+        }
+    }
+    mt19937_64 rng(42);
+    vector<string> keys(accounts);
+    for (string& key : keys) {
+        key = rng() % 16 == 0 ? "ACC" + to_string(rng()) : numbers[rng() % accounts];
+    }
+
+    vector<Account*> sequential(keys.size()), indexed(keys.size()), batched;
+    double getAccountSeconds = timeSeconds([&] {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            sequential[i] = bank.getAccount(keys[i]).get();
+        }
+    });
+    double findSeconds = timeSeconds([&] {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            indexed[i] = bank.findAccount(keys[i]);
+        }
+    });
+    double batchSeconds = timeSeconds([&] { bank.findAccounts(keys, batched); });
+    const double perLookup = 1e9 / keys.size();
+    cout << accounts << " accounts, " << keys.size() << " lookups" << endl;
+    cout << "  getAccount (map, one at a time):     " << setprecision(1)
+              << getAccountSeconds * perLookup << " ns/lookup" << endl;
+    cout << "  findAccount (hash, one at a time):   " << findSeconds * perLookup << " ns/lookup" << endl;
+    cout << "  findAccounts (hash, batched):        " << batchSeconds * perLookup << " ns/lookup ("
+              << setprecision(2) << getAccountSeconds / batchSeconds << "x vs getAccount, "
+              << findSeconds / batchSeconds << "x vs findAccount)" << endl;
+    bool same = sequential == batched && indexed == batched;
+    cout << "  Results " << (same ? "match" : "DIFFER") << endl;
+    return same ? 0 : 1;
+}
+
+// Applies the same `transfers` transfers (Zipf-skewed over 100k accounts, so hot accounts
+// conflict) with serial transferBatch and with the wave scheduler at several worker
+// counts, and checks every run ends in the same state.
+int runScheduleBenchmark(size_t transfers) {
+    const size_t accounts = 100000;
+    auto openAccounts = [&](Bank& bank) {
+        ScopedQuietOutput quiet;
+        bank.reserveAccounts(accounts);
+        string customerId = bank.addCustomer("Schedule Tester", "2 Wave St")->getCustomerId();
+        for (size_t i = 0; i < accounts; ++i) {
+            bank.createAccount(customerId, i % 2 ? "savings" : "checking", 500.0, 0.02, 100.0);
+        }
+    };
+    mt19937_64 rng(7);
+    ZipfSampler pick(accounts, 0.9);
+    vector<Bank::TransferRequest> batch(transfers);
+    for (auto& request : batch) {
+        size_t from = pick(rng), to = pick(rng);
+        request = {"ACC" + to_string(100000 + from), "ACC" + to_string(100000 + to),
+                   static_cast<double>(1 + rng() % 20000) / 100.0};
+    }
+
+    Bank serial("Serial Bank");
+    openAccounts(serial);
+    double serialSeconds = 0.0;
+    {
+        ScopedQuietOutput quiet;
+        serialSeconds = timeSeconds([&] { serial.transferBatch(batch); });
+    }
+    uint64_t expected = bankFingerprint(serial);
+    cout << transfers << " transfers over " << accounts << " accounts" << endl;
+    cout << "  serial transferBatch:          " << setprecision(3) << serialSeconds << " s" << endl;
+
+    bool allMatch = true;
+    vector<size_t> threadCounts = {0, 2, max<size_t>(2, thread::hardware_concurrency())};
+    threadCounts.erase(unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+    for (size_t threads : threadCounts) {
+        Bank scheduled("Scheduled Bank");
+        openAccounts(scheduled);
+        double seconds = 0.0;
+        {
+            ScopedQuietOutput quiet;
+            scheduled.configureWorkers(threads);
+            seconds = timeSeconds([&] { scheduled.transferBatchParallel(batch); });
+        }
+        bool match = bankFingerprint(scheduled) == expected;
+        allMatch = allMatch && match;
+        const JobStats& stats = scheduled.getJobStats().back();
+        cout << "  wave scheduler, " << threads << " worker(s):   " << setprecision(3) << seconds << " s ("
+                  << setprecision(2) << serialSeconds / seconds << "x), waves executing "
+                  << setprecision(1) << stats.wallSeconds * 1e3 << " ms, " << stats.tasks << " tasks, "
+                  << (match ? "state matches serial" : "STATE DIFFERS") << endl;
+    }
+    return allMatch ? 0 : 1;
+}
+
+// Runs the bulk jobs (accrual, reconciliation, export, statements) over `accounts`
+// savings accounts at several worker counts and prints each run's job statistics.
+int runJobsBenchmark(size_t accounts) {
+    vector<size_t> threadCounts = {1, 2, max<size_t>(2, thread::hardware_concurrency())};
+    threadCounts.erase(unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+    cout << accounts << " savings accounts" << endl;
+    for (size_t threads : threadCounts) {
+        Bank bank("Jobs Bank");
+        {
+            ScopedQuietOutput quiet;
+            bank.configureWorkers(threads);
+            string customerId = bank.addCustomer("Jobs Tester", "1 Batch Ln")->getCustomerId();
+            for (size_t i = 0; i < accounts; ++i) {
+                bank.createAccount(customerId, "savings", 100.0 + static_cast<double>(i % 1000), 0.03);
+            }
+            int today = currentDayNumber();
+            bank.accrueInterest(DailyCompoundPolicy<Actual365Fixed>(), AccrualPeriod{today - 30, today});
+            bank.reconcileAccounts();
+            ostringstream csv, statements;
+            bank.exportAccounts(csv);
+            bank.generateStatements(statements);
+        }
+        cout << "\n" << threads << " worker thread(s) plus the calling thread:";
+        bank.printJobStats();
+    }
+    return 0;
+}
+
+// Replays one workload serially and in deterministic mode with several worker counts.
+// Deterministic runs must agree with each other bit for bit (timestamps included) and
+// with the serial replay on balances and transaction sequences.
+int runDeterministicBenchmark(size_t operations) {
+    WorkloadConfig config;
+    config.operations = operations;
+    config.customers = 10000;
+    Workload workload = generateWorkload(config);
+
+    Bank serialBank("Serial Replay Bank");
+    ReplayResult serial = replayWorkload(serialBank, workload);
+    cout << workload.ops.size() << " operations (seed " << config.seed << ")" << endl;
+    cout << "  serial replay:                  " << setprecision(3) << serial.seconds << " s, "
+              << serial.applied << " applied" << endl;
+
+    const time_t logTime = time(nullptr);
+    bool allMatch = true;
+    uint64_t firstFingerprint = 0;
+    vector<size_t> threadCounts = {0, 1, 2, max<size_t>(2, thread::hardware_concurrency())};
+    threadCounts.erase(unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+    for (size_t threads : threadCounts) {
+        Bank bank("Deterministic Bank");
+        {
+            ScopedQuietOutput quiet;
+            bank.configureWorkers(threads);
+        }
+        ReplayResult result = replayWorkloadDeterministic(bank, workload, logTime);
+        if (threads == threadCounts.front()) {
+            firstFingerprint = result.fingerprint;
+        }
+        bool match = result.fingerprint == firstFingerprint && bankFingerprint(bank) == serial.fingerprint
+                     && result.applied == serial.applied;
+        allMatch = allMatch && match;
+        cout << "  deterministic, " << threads << " worker(s):     " << setprecision(3) << result.seconds << " s, "
+                  << result.applied << " applied, fingerprint " << hex << result.fingerprint << dec
+                  << (match ? "" : " (MISMATCH)") << endl;
+    }
+    cout << (allMatch ? "All runs identical." : "Runs DIFFER.") << endl;
+    return allMatch ? 0 : 1;
+}
+
+// Authorizes `holds` holds over 10k accounts with 1-30 day validity, captures a third,
+// releases a third and lets the rest expire one business day at a time.
+int runHoldsBenchmark(size_t holds) {
+    const size_t accounts = 10000;
+    Bank bank("Holds Bank");
+    vector<string> numbers;
+    vector<uint64_t> ids(holds);
+    double authorizeSeconds = 0.0, settleSeconds = 0.0, expirySeconds = 0.0;
+    size_t outstanding = 0;
+    {
+        ScopedQuietOutput quiet;
+        string customerId = bank.addCustomer("Holds Tester", "3 Card Ct")->getCustomerId();
+        for (size_t i = 0; i < accounts; ++i) {
+            numbers.push_back(bank.createAccount(customerId, "checking", 1e9, 0.0, 1000.0)->getAccountNumber());
+        }
+        mt19937_64 rng(11);
+        authorizeSeconds = timeSeconds([&] {
+            for (size_t i = 0; i < holds; ++i) {
+                ids[i] = bank.authorizeHold(numbers[rng() % accounts], 1.0 + rng() % 100, 1 + static_cast<int>(rng() % 30));
+            }
+        });
+        settleSeconds = timeSeconds([&] {
+            for (size_t i = 0; i < holds; ++i) {
+                if (i % 3 == 0) {
+                    bank.captureHold(ids[i], 1.0);
+                } else if (i % 3 == 1) {
+                    bank.releaseHold(ids[i]);
+                }
+            }
+        });
+        outstanding = bank.getOutstandingHoldCount();
+        expirySeconds = timeSeconds([&] {
+            for (int day = 0; day < 30; ++day) {
+                bank.advanceBusinessDays(1);
+            }
+        });
+    }
+    double stillHeld = 0.0;
+    for (const string& number : numbers) {
+        stillHeld += bank.findAccount(number)->getHeldAmount();
+    }
+    cout << holds << " holds over " << accounts << " accounts" << endl;
+    cout << "  authorize:        " << setprecision(1) << authorizeSeconds * 1e9 / holds << " ns/hold" << endl;
+    cout << "  capture/release:  " << settleSeconds * 1e9 / (holds - holds / 3) << " ns/hold" << endl;
+    cout << "  expiry (30 days): " << expirySeconds * 1e9 / max<size_t>(outstanding, 1) << " ns/expired hold, "
+              << outstanding << " expired" << endl;
+    bool ok = bank.getOutstandingHoldCount() == 0 && stillHeld == 0.0;
+    cout << (ok ? "  All holds settled." : "  Holds LEFT OVER.") << endl;
+    return ok ? 0 : 1;
+}
+
+// Queues `items` ACH items (70% credits) over 100k accounts and posts them at one cutoff,
+// against applying the same items one by one with deposit/withdraw in submission order.
+int runAchBenchmark(size_t items) {
+    const size_t accounts = 100000;
+    auto openAccounts = [&](Bank& bank, vector<string>& numbers) {
+        string customerId = bank.addCustomer("ACH Tester", "4 Cutoff Ave")->getCustomerId();
+        for (size_t i = 0; i < accounts; ++i) {
+            numbers.push_back(bank.createAccount(customerId, i % 2 ? "savings" : "checking", 100.0, 0.02, 250.0)
+                                  ->getAccountNumber());
+        }
+    };
+    mt19937_64 rng(5);
+    vector<uint32_t> target(items);
+    vector<double> amounts(items);
+    for (size_t i = 0; i < items; ++i) {
+        target[i] = static_cast<uint32_t>(rng() % accounts);
+        amounts[i] = static_cast<double>(1 + rng() % 10000) / 100.0 * (rng() % 10 < 7 ? 1 : -1);
+    }
+
+    Bank direct("Direct Bank"), core("Core Bank"), batched("Batched Bank");
+    vector<string> directNumbers, coreNumbers, batchedNumbers;
+    double directSeconds = 0.0, coreSeconds = 0.0, queueSeconds = 0.0, cutoffSeconds = 0.0;
+    {
+        ScopedQuietOutput quiet;
+        openAccounts(direct, directNumbers);
+        openAccounts(core, coreNumbers);
+        openAccounts(batched, batchedNumbers);
+        directSeconds = timeSeconds([&] {
+            for (size_t i = 0; i < items; ++i) {
+                Account& account = *direct.findAccount(directNumbers[target[i]]);
+                amounts[i] > 0 ? account.deposit(amounts[i]) : account.withdraw(-amounts[i]);
+            }
+        });
+        coreSeconds = timeSeconds([&] {
+            for (size_t i = 0; i < items; ++i) {
+                Account& account = *core.findAccount(coreNumbers[target[i]]);
+                amounts[i] > 0 ? account.postDeposit(amounts[i]) : account.postWithdrawal(-amounts[i]);
+            }
+        });
+        queueSeconds = timeSeconds([&] {
+            for (size_t i = 0; i < items; ++i) {
+                const string& number = batchedNumbers[target[i]];
+                amounts[i] > 0 ? batched.queueAchCredit(number, amounts[i]) : batched.queueAchDebit(number, -amounts[i]);
+            }
+        });
+        cutoffSeconds = timeSeconds([&] { batched.runAchCutoff(); });
+    }
+    uint64_t expected = bankFingerprint(direct);
+    bool match = bankFingerprint(core) == expected && bankFingerprint(batched) == expected;
+    cout << items << " ACH items over " << accounts << " accounts" << endl;
+    cout << "  deposit/withdraw one by one: " << setprecision(3) << directSeconds << " s ("
+              << setprecision(1) << directSeconds * 1e9 / items << " ns/item)" << endl;
+    cout << "  postDeposit/postWithdrawal:  " << setprecision(3) << coreSeconds << " s ("
+              << setprecision(1) << coreSeconds * 1e9 / items << " ns/item)" << endl;
+    cout << "  queue:                       " << setprecision(3) << queueSeconds << " s" << endl;
+    cout << "  cutoff (sort + bulk post):   " << cutoffSeconds << " s (" << setprecision(1)
+              << cutoffSeconds * 1e9 / items << " ns/item, " << setprecision(2) << coreSeconds / cutoffSeconds
+              << "x vs postDeposit/postWithdrawal)" << endl;
+    cout << "  Final state " << (match ? "matches" : "DIFFERS") << endl;
+    return match ? 0 : 1;
+}
+
+// Opens `accounts` accounts, closes a tenth, then measures the account filter's false-
+// positive rate and getAccount's cost for unknown, closed and live numbers, with the
+// filter on and off.
+int runFilterBenchmark(size_t accounts) {
+    Bank bank("Filter Bank");
+    vector<string> live, closed;
+    {
+        ScopedQuietOutput quiet;
+        string customerId = bank.addCustomer("Filter Tester", "5 Bloom Blvd")->getCustomerId();
+        for (size_t i = 0; i < accounts; ++i) {
+            string number = bank.createAccount(customerId, "checking", 0.0)->getAccountNumber();
+            (i % 10 == 0 ? closed : live).push_back(number);
+        }
+        for (const string& number : closed) {
+            bank.closeAccount(customerId, number);
+        }
+    }
+    mt19937_64 rng(3);
+    vector<string> unknown(accounts);
+    for (string& key : unknown) {
+        key = "ACC" + to_string(1000000000 + rng() % 1000000000); // Never issued
+    }
+    shuffle(live.begin(), live.end(), rng);
+
+    const BlockedBloomFilter& filter = bank.getAccountFilter();
+    size_t falsePositives = 0;
+    for (const string& key : unknown) {
+        falsePositives += filter.mayContain(key);
+    }
+    auto closedPassRate = [&] {
+        size_t passed = 0;
+        for (const string& key : closed) {
+            passed += filter.mayContain(key);
+        }
+        return 100.0 * passed / max<size_t>(closed.size(), 1);
+    };
+    double closedBefore = closedPassRate();
+    bank.compactLookupFilters();
+    cout << accounts << " accounts (" << closed.size() << " closed); filter holds " << filter.size() << " keys in "
+              << filter.memoryBytes() / 1024 << " KiB" << endl;
+    cout << "  false positives: " << setprecision(3) << 100.0 * falsePositives / unknown.size() << "% of unknown; "
+              << "closed accounts passing: " << closedBefore << "% before compaction, " << closedPassRate()
+              << "% after" << endl;
+
+    volatile size_t sink = 0;
+    auto timeLookups = [&](const vector<string>& keys) {
+        return timeSeconds([&] {
+            for (const string& key : keys) {
+                sink = sink + (bank.getAccount(key) != nullptr);
+            }
+        }) * 1e9 / keys.size();
+    };
+    for (bool enabled : {false, true}) {
+        bank.setLookupFiltersEnabled(enabled);
+        double unknownNs = timeLookups(unknown);
+        double closedNs = timeLookups(closed);
+        double liveNs = timeLookups(live);
+        cout << "  getAccount, filter " << (enabled ? "on: " : "off:") << "  unknown " << setprecision(1) << unknownNs
+                  << " ns, closed " << closedNs << " ns, live " << liveNs << " ns" << endl;
+    }
+    return 0;
+}
+
+// Latency percentile (0..1) of a sample, in microseconds.
+double latencyPercentile(vector<double> seconds, double fraction) {
+    size_t rank = min(seconds.size() - 1, static_cast<size_t>(fraction * seconds.size()));
+    nth_element(seconds.begin(), seconds.begin() + rank, seconds.end());
+    return seconds[rank] * 1e6;
+}
+
+// Routes `requests` deposits and transfers through the shards, a bounded window at a
+// time, and returns each request's latency from routing to completion. While
+// `migrating` is set, another thread keeps moving the hot accounts (the ones most
+// requests touch) to the next shard.
+template <class BankType>
+vector<double> runRoutedTraffic(BankType& bank, ShardRuntime& shards, const vector<string>& numbers,
+                                size_t hotAccounts, size_t requests, bool migrating, atomic<size_t>& deposits) {
+    vector<double> latency(requests);
+    atomic<size_t> completed{0};
+    atomic<bool> stop{false};
+    thread migrator;
+    if (migrating) {
+        migrator = thread([&] {
+            for (size_t round = 0; !stop.load(); ++round) {
+                const string& number = numbers[round % hotAccounts];
+                bank.migrateAccount(number, (shards.shardFor(number) + 1) % shards.shardCount());
+            }
+        });
+    }
+    const size_t window = 256;
+    mt19937_64 rng(17);
+    for (size_t i = 0; i < requests; ++i) {
+        while (i - completed.load(memory_order_acquire) >= window) {
+            this_thread::yield();
+        }
+        bool hot = rng() % 2 == 0;
+        const string& a = numbers[hot ? rng() % hotAccounts : rng() % numbers.size()];
+        const string& b = numbers[rng() % numbers.size()];
+        auto start = chrono::steady_clock::now();
+        auto finish = [&latency, &completed, i, start] {
+            latency[i] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            completed.fetch_add(1, memory_order_release);
+        };
+        if (rng() % 2 == 0 || a == b) {
+            shards.route({a}, [&bank, &deposits, &a, finish] {
+                deposits += bank.deposit(a, 1.0);
+                finish();
+            });
+        } else {
+            shards.route({a, b}, [&bank, &a, &b, finish] {
+                bank.transferFunds(a, b, 1.0);
+                finish();
+            });
+        }
+    }
+    while (completed.load(memory_order_acquire) < requests) {
+        this_thread::yield();
+    }
+    stop.store(true);
+    if (migrator.joinable()) {
+        migrator.join();
+    }
+    return latency;
+}
+
+// Request latency on sharded accounts with and without live migrations of hot accounts,
+// and how long each migration took. Money must be conserved across migrations.
+int runMigrationBenchmark(size_t requests) {
+    using ConcurrentBank = BasicBank<Concurrent, InMemory, NoInstrumentation, SilentLog>;
+    NumaTopology topology = NumaTopology::detect();
+    ShardRuntime shards(topology, 4);
+    ConcurrentBank bank("Migration Bank");
+    bank.attachShards(&shards);
+    const size_t accountCount = 2000;
+    const size_t hotAccounts = 16;
+    vector<string> numbers;
+    string customerId = bank.addCustomer("Migration Tester", "1 Handoff Rd")->getCustomerId();
+    for (size_t i = 0; i < accountCount; ++i) {
+        numbers.push_back(bank.createAccount(customerId, "checking", 1000.0)->getAccountNumber());
+    }
+    cout << requests << " routed requests per run, " << accountCount << " accounts (" << hotAccounts
+              << " hot) on " << shards.shardCount() << " shards, " << topology.nodeCount() << " NUMA node(s)"
+              << (topology.emulated ? " (emulated)" : "") << endl;
+    atomic<size_t> deposits{0};
+    bool conserved = true;
+    for (bool migrating : {false, true}) {
+        size_t before = shards.getMigrations().size();
+        vector<double> latency = runRoutedTraffic(bank, shards, numbers, hotAccounts, requests, migrating, deposits);
+        cout << "  " << left << setw(18) << (migrating ? "with migrations" : "no migrations") << right
+                  << setprecision(1) << "p50 " << setw(8) << latencyPercentile(latency, 0.5) << " us  p99 "
+                  << setw(8) << latencyPercentile(latency, 0.99) << " us  p99.9 " << setw(8)
+                  << latencyPercentile(latency, 0.999) << " us  max " << setw(9) << latencyPercentile(latency, 1.0)
+                  << " us" << endl;
+        vector<MigrationStats> migrations = shards.getMigrations();
+        if (migrating && migrations.size() > before) {
+            double drain = 0.0, copy = 0.0, total = 0.0, worst = 0.0;
+            size_t queued = 0;
+            for (size_t i = before; i < migrations.size(); ++i) {
+                drain += migrations[i].drainSeconds;
+                copy += migrations[i].copySeconds;
+                total += migrations[i].totalSeconds;
+                worst = max(worst, migrations[i].totalSeconds);
+                queued += migrations[i].queuedRequests;
+            }
+            double count = static_cast<double>(migrations.size() - before);
+            cout << "    " << migrations.size() - before << " migrations: mean " << setprecision(1)
+                      << total / count * 1e6 << " us (drain " << drain / count * 1e6 << " us, copy "
+                      << copy / count * 1e6 << " us), max " << worst * 1e6 << " us, " << setprecision(2)
+                      << queued / count << " requests queued per handoff" << endl;
+        }
+        double total = 0.0;
+        bank.totalBalances(Currency::USD, total);
+        conserved &= fabs(total - (1000.0 * accountCount + static_cast<double>(deposits.load()))) < 0.005;
+    }
+    cout << "  Money " << (conserved ? "conserved" : "NOT CONSERVED") << endl;
+    return conserved ? 0 : 1;
+}
+
+// Customer account enumeration and owner lookup: the CSR relationship index against the
+// layout it replaced (a map of accounts per customer) plus an account -> owner ID map.
+int runRelationsBenchmark(size_t customers) {
+    using SilentBank = BasicBank<SingleThreaded, InMemory, NoInstrumentation, SilentLog>;
+    SilentBank bank("Relations Bank");
+    vector<string> customerIds;
+    vector<string> numbers;
+    mt19937_64 rng(31);
+    for (size_t c = 0; c < customers; ++c) {
+        customerIds.push_back(bank.addCustomer("Customer " + to_string(c), "1 Graph St")->getCustomerId());
+        for (size_t a = 0; a < 1 + rng() % 6; ++a) {
+            numbers.push_back(bank.createAccount(customerIds.back(), a % 2 ? "checking" : "savings", 100.0)->getAccountNumber());
+        }
+    }
+    for (size_t i = 0; i < numbers.size() / 10; ++i) { // One account in ten is joint
+        bank.addJointOwner(numbers[rng() % numbers.size()], customerIds[rng() % customers]);
+    }
+    // The previous layout, built from the same relationships.
+    vector<map<string, shared_ptr<Account>>> accountMaps(customers);
+    unordered_map<string, vector<string>> ownerIds;
+    for (size_t c = 0; c < customers; ++c) {
+        for (const Account* account : bank.getCustomer(customerIds[c])->getAccounts()) {
+            accountMaps[c][account->getAccountNumber()] = bank.getAccount(account->getAccountNumber());
+            ownerIds[account->getAccountNumber()].push_back(customerIds[c]);
+        }
+    }
+    vector<shared_ptr<Customer>> customerObjects;
+    for (const string& id : customerIds) {
+        customerObjects.push_back(bank.getCustomer(id));
+    }
+    cout << customers << " customers, " << numbers.size() << " accounts, " << bank.getRelations().ownershipCount()
+              << " ownerships" << endl;
+
+    const int passes = 10;
+    double sumMaps = 0.0, sumCsr = 0.0;
+    double mapSeconds = timeSeconds([&] {
+        for (int pass = 0; pass < passes; ++pass) {
+            for (const auto& accounts : accountMaps) {
+                for (const auto& pair : accounts) {
+                    sumMaps += pair.second->getBalance();
+                }
+            }
+        }
+    });
+    double csrSeconds = timeSeconds([&] {
+        for (int pass = 0; pass < passes; ++pass) {
+            for (const auto& customer : customerObjects) {
+                for (const Account* account : customer->getAccounts()) {
+                    sumCsr += account->getBalance();
+                }
+            }
+        }
+    });
+    double perOwnership = 1e9 / (static_cast<double>(passes) * bank.getRelations().ownershipCount());
+    cout << "  enumerate every customer's accounts: map per customer " << setprecision(1) << mapSeconds * perOwnership
+              << " ns/account, CSR row " << csrSeconds * perOwnership << " ns/account" << endl;
+
+    vector<const Account*> probes;
+    vector<const string*> probeNumbers;
+    for (size_t i = 0; i < 1000000; ++i) {
+        const string& number = numbers[rng() % numbers.size()];
+        probeNumbers.push_back(&number);
+        probes.push_back(bank.findAccount(number));
+    }
+    size_t ownersMap = 0, ownersCsr = 0;
+    double ownerMapSeconds = timeSeconds([&] {
+        for (const string* number : probeNumbers) {
+            ownersMap += ownerIds.find(*number)->second.size();
+        }
+    });
+    const RelationshipIndex& relations = bank.getRelations();
+    double ownerCsrSeconds = timeSeconds([&] {
+        for (const Account* account : probes) {
+            for (uint32_t slot : relations.ownersOf(*account)) {
+                ownersCsr += relations.customerAt(slot)->getCustomerId().size() > 0;
+            }
+        }
+    });
+    cout << "  owner lookup: hash map by account number " << setprecision(1) << ownerMapSeconds * 1e9 / probes.size()
+              << " ns, CSR row from the account " << ownerCsrSeconds * 1e9 / probes.size() << " ns" << endl;
+    bool agree = fabs(sumMaps - sumCsr) < 0.01 && ownersMap == ownersCsr;
+    cout << "  Results " << (agree ? "agree" : "DISAGREE") << endl;
+    return agree ? 0 : 1;
+}
+
+// 3-hop money-flow traces over a synthetic year of transfers: the CSR-indexed graph
+// (sequential and on the worker pool) against one pass over the transfer log per hop,
+// which is what tracing costs without an index. One destination in eight is one of the
+// busiest 1% of accounts (merchants), so some traces fan out widely.
+int runFlowTraceBenchmark(size_t edges) {
+    const uint32_t accounts = static_cast<uint32_t>(max<size_t>(edges / 10, 1000));
+    const uint32_t hubs = accounts / 100;
+    const uint32_t yearStart = 1700000000, day = 86400;
+    mt19937_64 rng(73);
+    TransferGraph graph;
+    graph.reserve(edges);
+    double logSeconds = timeSeconds([&] {
+        for (size_t i = 0; i < edges; ++i) {
+            uint64_t r = rng();
+            uint32_t from = static_cast<uint32_t>(r % accounts);
+            uint32_t to = (r >> 32) % 8 == 0 ? static_cast<uint32_t>((r >> 35) % hubs) : static_cast<uint32_t>((r >> 32) % accounts);
+            graph.record({from, to, 0, 0, yearStart + static_cast<uint32_t>(uint64_t(365) * day * i / edges)});
+        }
+    });
+    double indexSeconds = timeSeconds([&] { graph.buildIndex(); });
+    cout << edges << " transfer edges over " << accounts << " accounts: logged in " << fixed << setprecision(2)
+              << logSeconds << " s (" << setprecision(1) << logSeconds * 1e9 / edges << " ns/edge), indexed in "
+              << setprecision(2) << indexSeconds << " s" << endl;
+
+    vector<uint32_t> starts(200);
+    for (uint32_t& start : starts) {
+        start = static_cast<uint32_t>(rng() % accounts);
+    }
+    const time_t windowStart = yearStart + 120 * day, windowEnd = windowStart + 30 * day;
+    unique_ptr<ThreadPool> pool;
+    if (thread::hardware_concurrency() > 1) {
+        pool = make_unique<ThreadPool>(thread::hardware_concurrency() - 1); // Plus the calling thread
+    }
+    auto runTraces = [&](const char* label, time_t from, time_t to, ThreadPool* workers) {
+        size_t reached = 0, scanned = 0;
+        double seconds = timeSeconds([&] {
+            for (uint32_t start : starts) {
+                FlowTrace trace = graph.trace(start, 3, from, to, workers);
+                reached += trace.accounts.size();
+                scanned += trace.edgesScanned;
+            }
+        });
+        cout << "  3-hop trace, " << label << (workers ? ", pool" : ", 1 thread") << ": " << setprecision(3)
+                  << seconds * 1e3 / starts.size() << " ms/trace, " << reached / starts.size() << " accounts reached, "
+                  << scanned / starts.size() << " edges scanned" << endl;
+        return reached;
+    };
+    size_t yearReached = runTraces("whole year", yearStart, yearStart + 366 * day, nullptr);
+    size_t windowReached = runTraces("30-day window", windowStart, windowEnd, nullptr);
+    if (pool) {
+        runTraces("whole year", yearStart, yearStart + 366 * day, pool.get());
+        runTraces("30-day window", windowStart, windowEnd, pool.get());
+    } else {
+        cout << "  (one hardware thread: pool runs skipped)" << endl;
+    }
+
+    // Without an index: each hop is a pass over the whole log, checking each edge's source
+    // against the previous level.
+    const size_t scanStarts = 3;
+    size_t scanReached = 0;
+    vector<uint8_t> level(accounts);
+    double scanSeconds = timeSeconds([&] {
+        for (size_t s = 0; s < scanStarts; ++s) {
+            fill(level.begin(), level.end(), 0);
+            level[starts[s]] = 1;
+            for (uint8_t hop = 1; hop <= 3; ++hop) {
+                for (uint32_t id = 1; id <= edges; ++id) {
+                    const TransferEdge* edge = graph.transfer(id);
+                    if (edge->date >= windowStart && edge->date <= windowEnd && level[edge->from] == hop && level[edge->to] == 0) {
+                        level[edge->to] = hop + 1;
+                        ++scanReached;
+                    }
+                }
+            }
+        }
+    });
+    size_t indexedReached = 0;
+    for (size_t s = 0; s < scanStarts; ++s) {
+        indexedReached += graph.trace(starts[s], 3, windowStart, windowEnd).accounts.size();
+    }
+    cout << "  3-hop trace, 30-day window, log scan per hop: " << setprecision(1) << scanSeconds * 1e3 / scanStarts
+              << " ms/trace" << endl;
+    bool agree = scanReached == indexedReached && yearReached >= windowReached;
+    cout << "  Results " << (agree ? "agree" : "DISAGREE") << endl;
+    return agree ? 0 : 1;
+}
+
+// Streaming anomaly detection: the detector's own cost per posting, the cost of a whole
+// posting with it, and how well it finds injected outliers. Each account's amounts are
+// lognormal around its own typical size; 1 posting in 200 is replaced by one 10x larger.
+int runAnomalyBenchmark(size_t postings) {
+    const size_t accounts = 64;
+    mt19937_64 rng(17);
+    lognormal_distribution<double> spread(0.0, 0.35);
+    vector<double> typical(accounts);
+    for (double& size : typical) {
+        size = 20.0 + static_cast<double>(rng() % 2000);
+    }
+    vector<double> amounts(postings);
+    vector<uint8_t> injected(postings);
+    for (size_t i = 0; i < postings; ++i) {
+        injected[i] = rng() % 200 == 0;
+        amounts[i] = typical[i % accounts] * spread(rng) * (injected[i] ? 10.0 : 1.0);
+    }
+
+    vector<AmountStats> stats(accounts);
+    const double sigmasSquared = kDefaultAnomalySigmas * kDefaultAnomalySigmas;
+    size_t flagged = 0;
+    double observeSeconds = timeSeconds([&] {
+        for (size_t i = 0; i < postings; ++i) {
+            flagged += stats[i % accounts].observe(amounts[i], sigmasSquared);
+        }
+    });
+
+    vector<unique_ptr<CheckingAccount>> owners;
+    for (size_t a = 0; a < accounts; ++a) {
+        owners.push_back(make_unique<CheckingAccount>("ANOM" + to_string(a), "Anomaly Tester", 1e12));
+        owners.back()->reserveHistory(postings / accounts + 1);
+    }
+    tlsTransactionTime = 1700000000; // Fixed stamps: time this path, not the clock
+    double postSeconds = timeSeconds([&] {
+        for (size_t i = 0; i < postings; ++i) {
+            owners[i % accounts]->postDeposit(amounts[i]);
+        }
+    });
+    tlsTransactionTime = 0;
+
+    size_t truePositives = 0, falsePositives = 0, outliers = 0;
+    for (size_t a = 0; a < accounts; ++a) {
+        const vector<Transaction>& history = owners[a]->getTransactionHistory();
+        for (size_t k = 0; k < history.size(); ++k) {
+            bool spike = injected[a + k * accounts];
+            outliers += spike;
+            truePositives += spike && history[k].anomalous;
+            falsePositives += !spike && history[k].anomalous;
+        }
+    }
+    cout << postings << " deposits over " << accounts << " accounts, k = " << setprecision(1) << kDefaultAnomalySigmas << endl;
+    cout << "  AmountStats::observe alone:  " << setprecision(2) << observeSeconds * 1e9 / postings << " ns" << endl;
+    cout << "  Account::postDeposit:        " << postSeconds * 1e9 / postings << " ns (detector included)" << endl;
+    cout << "  injected outliers flagged:   " << truePositives << " of " << outliers << " ("
+              << setprecision(1) << 100.0 * truePositives / max<size_t>(outliers, 1) << "%)" << endl;
+    cout << "  other postings flagged:      " << falsePositives << " (" << setprecision(3)
+              << 100.0 * falsePositives / max<size_t>(postings - outliers, 1) << "%)" << endl;
+    bool agree = flagged == truePositives + falsePositives;
+    cout << "  Results " << (agree ? "agree" : "DISAGREE") << endl;
+    return agree ? 0 : 1;
+}
+
+// Request rate limiting: what the limiter adds to a deposit (limits generous enough to
+// admit everything), admit() on its own, and a flood on one account interleaved with
+// ordinary traffic on the other 4095. A flooded account is rejected before its owner is
+// charged, so the owner's other accounts keep working.
+int runRateLimitBenchmark(size_t requests) {
+    using SilentBank = BasicBank<SingleThreaded, InMemory, NoInstrumentation, SilentLog>;
+    SilentBank bank("Limited Bank");
+    const size_t customers = 1024, accountsPerCustomer = 4;
+    vector<string> numbers, owners;
+    for (size_t c = 0; c < customers; ++c) {
+        string customerId = bank.addCustomer("Limit Tester " + to_string(c), "1 Bench St")->getCustomerId();
+        for (size_t a = 0; a < accountsPerCustomer; ++a) {
+            shared_ptr<Account> account = bank.createAccount(customerId, "checking", 0.0);
+            account->reserveHistory(5 * requests / (customers * accountsPerCustomer) + 256);
+            numbers.push_back(account->getAccountNumber());
+            owners.push_back(customerId);
+        }
+    }
+    mt19937_64 rng(23);
+    vector<uint32_t> order(requests);
+    for (uint32_t& index : order) {
+        index = static_cast<uint32_t>(rng() % numbers.size());
+    }
+    tlsTransactionTime = 1700000000; // Fixed stamps: time the request path, not the clock
+
+    const RateLimit generous{1e6, 1e6};
+    size_t admittedOff = 0, admittedOn = 0;
+    double offSeconds = 1e9, onSeconds = 1e9;
+    for (int round = 0; round < 2; ++round) { // Best of two, alternating
+        bank.configureRateLimits({}, {});
+        offSeconds = min(offSeconds, timeSeconds([&] {
+            admittedOff = 0;
+            for (uint32_t index : order) {
+                admittedOff += bank.deposit(numbers[index], 1.0);
+            }
+        }));
+        bank.configureRateLimits(generous, generous);
+        onSeconds = min(onSeconds, timeSeconds([&] {
+            admittedOn = 0;
+            for (uint32_t index : order) {
+                admittedOn += bank.deposit(numbers[index], 1.0);
+            }
+        }));
+    }
+
+    RateLimiter limiter;
+    limiter.configure(generous, generous);
+    for (size_t i = 0; i < numbers.size(); ++i) {
+        limiter.addCustomer(owners[i]);
+        limiter.addAccount(numbers[i], owners[i]);
+    }
+    size_t admittedAlone = 0;
+    double admitSeconds = timeSeconds([&] {
+        for (uint32_t index : order) {
+            admittedAlone += limiter.admit(numbers[index], coarseSteadyNanos());
+        }
+    });
+
+    // Every other request floods numbers[0]; 1000/s with a burst of 1000 per account, and
+    // 4000/s with a burst of 4000 per customer.
+    bank.configureRateLimits({1000.0, 1000.0}, {4000.0, 4000.0});
+    size_t floodSent = 0, floodAdmitted = 0, otherSent = 0, otherAdmitted = 0;
+    double floodSeconds = timeSeconds([&] {
+        for (size_t i = 0; i < requests; ++i) {
+            bool flood = i % 2 == 0;
+            uint32_t index = flood ? 0 : order[i] % (numbers.size() - 1) + 1;
+            bool admitted = bank.deposit(numbers[index], 1.0);
+            (flood ? floodSent : otherSent) += 1;
+            (flood ? floodAdmitted : otherAdmitted) += admitted;
+        }
+    });
+    const size_t rejectRuns = requests / 4;
+    size_t lateAdmitted = 0;
+    double rejectSeconds = timeSeconds([&] {
+        for (size_t i = 0; i < rejectRuns; ++i) {
+            lateAdmitted += bank.deposit(numbers[0], 1.0);
+        }
+    });
+    tlsTransactionTime = 0;
+
+    cout << requests << " deposits over " << numbers.size() << " accounts of " << customers << " customers" << endl;
+    cout << "  Bank::deposit, no limits:       " << setprecision(1) << offSeconds * 1e9 / requests << " ns" << endl;
+    cout << "  Bank::deposit, limits enforced: " << onSeconds * 1e9 / requests << " ns (+"
+              << (onSeconds - offSeconds) * 1e9 / requests << " ns)" << endl;
+    cout << "  RateLimiter::admit + clock:     " << admitSeconds * 1e9 / requests << " ns" << endl;
+    cout << "  Flood (every other request on one account, " << setprecision(3) << floodSeconds << " s):" << endl;
+    cout << "    flooded account admitted " << floodAdmitted << " of " << floodSent << endl;
+    cout << "    other accounts admitted  " << otherAdmitted << " of " << otherSent << endl;
+    cout << "    rejected request:        " << setprecision(1) << rejectSeconds * 1e9 / rejectRuns << " ns ("
+              << lateAdmitted << " refilled tokens admitted meanwhile)" << endl;
+    bool agree = admittedOff == requests && admittedOn == requests && admittedAlone == requests
+                 && otherAdmitted == otherSent && floodAdmitted < floodSent;
+    cout << "  Results " << (agree ? "agree" : "DISAGREE") << endl;
+    return agree ? 0 : 1;
+}
+
+// Replays `workload` on `bank` and prints the profile's time and throughput.
+template <class BankType>
+ReplayResult benchProfile(const string& label, BankType& bank, const Workload& workload) {
+    ReplayResult result = replayWorkload(bank, workload);
+    cout << "  " << left << setw(37) << label << right << setprecision(3) << result.seconds << " s  "
+              << setprecision(0) << setw(9) << workload.ops.size() / result.seconds << " ops/s  fingerprint "
+              << hex << result.fingerprint << dec << endl;
+    return result;
+}
+
+// Replays one seeded workload through each build profile. Every profile must end in the
+// same state, and replaying the journaled profile's journal into a fresh bank must
+// reproduce it.
+int runProfilesBenchmark(size_t operations) {
+    using SilentBank = BasicBank<SingleThreaded, InMemory, NoInstrumentation, SilentLog>;
+    using ConcurrentBank = BasicBank<Concurrent, InMemory, NoInstrumentation, SilentLog>;
+    using JournaledBank = BasicBank<SingleThreaded, Journaled, NoInstrumentation, SilentLog>;
+    using InstrumentedBank = BasicBank<SingleThreaded, InMemory, OpCounters, SilentLog>;
+    using FullBank = BasicBank<Concurrent, Journaled, OpCounters, ConsoleLog>;
+    WorkloadConfig config;
+    config.operations = operations;
+    config.customers = 10000;
+    Workload workload = generateWorkload(config);
+    cout << "Replaying " << workload.ops.size() << " operations per profile (sizeof Bank " << sizeof(Bank)
+              << ", silent " << sizeof(SilentBank) << ", concurrent " << sizeof(ConcurrentBank) << ", journaled "
+              << sizeof(JournaledBank) << ", instrumented " << sizeof(InstrumentedBank) << " bytes)" << endl;
+
+    vector<uint64_t> fingerprints;
+    {
+        Bank bank("Console Bank");
+        fingerprints.push_back(benchProfile("console (Bank)", bank, workload).fingerprint);
+    }
+    {
+        SilentBank bank("Silent Bank");
+        fingerprints.push_back(benchProfile("silent", bank, workload).fingerprint);
+    }
+    {
+        ConcurrentBank bank("Concurrent Bank");
+        fingerprints.push_back(benchProfile("concurrent, silent", bank, workload).fingerprint);
+    }
+    ostringstream journal;
+    {
+        JournaledBank bank("Journaled Bank");
+        bank.getPersistence().attachJournal(journal);
+        fingerprints.push_back(benchProfile("journaled, silent", bank, workload).fingerprint);
+        cout << "    journal: " << bank.getPersistence().getJournalRecordCount() << " records, "
+                  << journal.str().size() / (1024 * 1024) << " MiB" << endl;
+    }
+    {
+        InstrumentedBank bank("Instrumented Bank");
+        fingerprints.push_back(benchProfile("instrumented, silent", bank, workload).fingerprint);
+        bank.getInstrumentation().printOpStats();
+    }
+    {
+        FullBank bank("Full Bank");
+        ostringstream fullJournal;
+        bank.getPersistence().attachJournal(fullJournal);
+        fingerprints.push_back(benchProfile("concurrent, journaled, instrumented", bank, workload).fingerprint);
+    }
+
+    SilentBank recovered("Recovered Bank");
+    istringstream in(journal.str());
+    size_t records = 0;
+    double seconds = timeSeconds([&] { records = recovered.applyJournal(in); });
+    bool recoveredMatches = bankFingerprint(recovered) == fingerprints[0];
+    cout << "  journal recovery: " << records << " records in " << setprecision(3) << seconds << " s, state "
+              << (recoveredMatches ? "matches" : "DIFFERS") << endl;
+    bool match = recoveredMatches;
+    for (uint64_t fingerprint : fingerprints) {
+        match &= fingerprint == fingerprints[0];
+    }
+    cout << "  All profiles " << (match ? "agree" : "DISAGREE") << endl;
+    return match ? 0 : 1;
+}
+
+// What the standby process reports back to the primary when it has caught up.
+struct StandbyReport {
+    uint64_t fingerprint = 0;
+    uint64_t records = 0;
+    uint64_t rejected = 0;
+    uint64_t heartbeats = 0;
+    double lagP50 = 0.0; // Microseconds
+    double lagP99 = 0.0;
+    double lagP999 = 0.0;
+    double lagMax = 0.0;
+};
+
+// The standby process: follows the journal until it has applied `expected` records (sent
+// over `control` once the primary stops), then reports on `results`.
+[[noreturn]] void runStandbyProcess(const string& path, int control, int results) {
+    using SilentBank = BasicBank<SingleThreaded, InMemory, NoInstrumentation, SilentLog>;
+    SilentBank standby("Standby Bank");
+    JournalFollower follower(path);
+    uint64_t expected = numeric_limits<uint64_t>::max();
+    while (follower.getRecordCount() < expected) {
+        if (follower.poll(standby) > 0) {
+            continue;
+        }
+        pollfd pending{control, POLLIN, 0};
+        if (expected == numeric_limits<uint64_t>::max() && ::poll(&pending, 1, 0) > 0
+            && read(control, &expected, sizeof(expected)) != sizeof(expected)) {
+            _exit(1);
+        }
+        this_thread::sleep_for(chrono::microseconds(50));
+    }
+    StandbyReport report;
+    report.fingerprint = bankFingerprint(standby);
+    report.records = follower.getRecordCount();
+    report.rejected = follower.getRejectedCount();
+    const vector<double>& lag = follower.getLagSamples();
+    report.heartbeats = lag.size();
+    if (!lag.empty()) {
+        report.lagP50 = latencyPercentile(lag, 0.5);
+        report.lagP99 = latencyPercentile(lag, 0.99);
+        report.lagP999 = latencyPercentile(lag, 0.999);
+        report.lagMax = latencyPercentile(lag, 1.0);
+    }
+    bool sent = write(results, &report, sizeof(report)) == sizeof(report);
+    _exit(sent ? 0 : 1);
+}
+
+// Replays a workload at full speed on a journaled primary while a standby process
+// follows its journal file, heartbeating every millisecond. Reports the primary's
+// throughput next to a primary without a standby, the standby's lag at each heartbeat
+// and how long it needed to catch up after the primary stopped. The standby must end in
+// the primary's state.
+int runReplicationBenchmark(size_t operations) {
+    using JournaledBank = BasicBank<SingleThreaded, Journaled, NoInstrumentation, SilentLog>;
+    WorkloadConfig config;
+    config.operations = operations;
+    config.customers = 10000;
+    Workload workload = generateWorkload(config);
+    const string path = "/tmp/bank-replication-" + to_string(getpid()) + ".journal";
+    auto runPrimary = [&](JournaledBank& primary) {
+        ofstream out(path, ios::trunc);
+        primary.getPersistence().attachJournal(out);
+        atomic<bool> done{false};
+        thread heartbeat([&] {
+            while (!done.load()) {
+                primary.journalHeartbeat();
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+        });
+        ReplayResult result = replayWorkload(primary, workload);
+        done.store(true);
+        heartbeat.join();
+        primary.journalHeartbeat();
+        primary.getPersistence().detachJournal();
+        return result;
+    };
+    cout << "Replaying " << workload.ops.size() << " operations on a journaled primary" << endl;
+    {
+        JournaledBank primary("Primary Bank");
+        ReplayResult alone = runPrimary(primary);
+        cout << "  no standby:    " << setprecision(3) << alone.seconds << " s  " << setprecision(0)
+                  << workload.ops.size() / alone.seconds << " ops/s, " << primary.getPersistence().getJournalRecordCount()
+                  << " records" << endl;
+    }
+
+    JournaledBank primary("Primary Bank");
+    { ofstream create(path, ios::trunc); }
+    int control[2];
+    int results[2];
+    if (pipe(control) != 0 || pipe(results) != 0) {
+        cout << "Cannot create pipes for the standby." << endl;
+        return 1;
+    }
+    cout.flush();
+    pid_t standby = fork();
+    if (standby == 0) {
+        close(control[1]);
+        close(results[0]);
+        runStandbyProcess(path, control[0], results[1]);
+    }
+    close(control[0]);
+    close(results[1]);
+    ReplayResult result = runPrimary(primary);
+    uint64_t records = primary.getPersistence().getJournalRecordCount();
+    StandbyReport report;
+    bool received = false;
+    double catchUp = timeSeconds([&] {
+        received = write(control[1], &records, sizeof(records)) == sizeof(records)
+                   && read(results[0], &report, sizeof(report)) == sizeof(report);
+    });
+    int status = 0;
+    waitpid(standby, &status, 0);
+    close(control[1]);
+    close(results[0]);
+    remove(path.c_str());
+    if (!received) {
+        cout << "The standby process did not report back." << endl;
+        return 1;
+    }
+    bool matches = report.fingerprint == bankFingerprint(primary) && report.rejected == 0;
+    cout << "  with standby:  " << setprecision(3) << result.seconds << " s  " << setprecision(0)
+              << workload.ops.size() / result.seconds << " ops/s, " << records << " records" << endl;
+    cout << "  standby lag over " << report.heartbeats << " heartbeats: p50 " << setprecision(1) << report.lagP50
+              << " us  p99 " << report.lagP99 << " us  p99.9 " << report.lagP999 << " us  max " << report.lagMax
+              << " us" << endl;
+    cout << "  caught up " << setprecision(1) << catchUp * 1e3 << " ms after the primary stopped; "
+              << report.rejected << " records rejected; state " << (matches ? "matches" : "DIFFERS") << endl;
+    return matches ? 0 : 1;
+}
+
+// What the reader process measured.
+struct ReplicaReaderReport {
+    uint64_t reads = 0;
+    uint64_t retries = 0;      // Seqlock reads discarded because a write overlapped
+    uint64_t inconsistent = 0; // Snapshots whose newest history entry disagrees with the balance
+    uint64_t missing = 0;
+    double readSeconds = 0.0;
+    uint64_t roundTrips = 0;
+    double roundTripSeconds = 0.0;
+};
+
+// The reader process: looks balances up in the shared table, then asks the bank process
+// for them over a socket, and reports both on `results`.
+[[noreturn]] void runReplicaReader(const string& tableName, const vector<string>& numbers, size_t reads,
+                                   int socket, int results) {
+    ReplicaReaderReport report;
+    SharedBalanceTable table(tableName);
+    mt19937_64 rng(23);
+    BalanceSnapshot snapshot;
+    double checksum = 0.0;
+    report.readSeconds = timeSeconds([&] {
+        for (size_t i = 0; i < reads; ++i) {
+            if (!table.read(numbers[rng() % numbers.size()], snapshot, &report.retries)) {
+                ++report.missing;
+                continue;
+            }
+            checksum += snapshot.balance;
+            const PublishedTransaction* newest = snapshot.recentCount ? &snapshot.recent[snapshot.recentCount - 1] : nullptr;
+            report.inconsistent += newest && fabs(newest->newBalance - snapshot.balance) >= 0.005;
+        }
+    });
+    report.reads = reads;
+    report.roundTrips = reads / 100;
+    report.roundTripSeconds = timeSeconds([&] {
+        for (size_t i = 0; i < report.roundTrips; ++i) {
+            uint32_t index = static_cast<uint32_t>(rng() % numbers.size());
+            double balance = 0.0;
+            if (write(socket, &index, sizeof(index)) != sizeof(index) || read(socket, &balance, sizeof(balance)) != sizeof(balance)) {
+                _exit(1);
+            }
+            checksum += balance;
+        }
+    });
+    uint32_t done = numeric_limits<uint32_t>::max();
+    bool sent = write(socket, &done, sizeof(done)) == sizeof(done) && checksum != -1.0
+                && write(results, &report, sizeof(report)) == sizeof(report);
+    _exit(sent ? 0 : 1);
+}
+
+// Balance reads from another process: lock-free from the shared balance table versus a
+// round-trip to the bank process over a Unix socket, while the bank keeps posting
+// deposits. Also reports what publishing adds to each posting.
+int runReplicasBenchmark(size_t reads) {
+    using SilentBank = BasicBank<SingleThreaded, InMemory, NoInstrumentation, SilentLog>;
+    const size_t accountCount = 100000;
+    SilentBank bank("Replica Bank");
+    vector<string> numbers;
+    string customerId = bank.addCustomer("Replica Tester", "1 Mirror Ln")->getCustomerId();
+    for (size_t i = 0; i < accountCount; ++i) {
+        numbers.push_back(bank.createAccount(customerId, "checking", 100.0)->getAccountNumber());
+    }
+    const size_t deposits = 4000000;
+    auto timeDeposits = [&] {
+        return timeSeconds([&] {
+            for (size_t i = 0; i < deposits; ++i) {
+                bank.deposit(numbers[i % accountCount], 1.0);
+            }
+        }) * 1e9 / deposits;
+    };
+    double unpublishedNs = timeDeposits();
+    SharedBalanceTable table("/bank-bench-" + to_string(getpid()), accountCount);
+    bank.publishBalances(&table);
+    double publishedNs = timeDeposits();
+    cout << accountCount << " accounts published to " << table.getName() << " (" << table.capacity() << " slots of "
+              << sizeof(BalanceSlot) << " bytes)" << endl;
+    cout << "  deposit: " << setprecision(1) << unpublishedNs << " ns unpublished, " << publishedNs
+              << " ns published" << endl;
+
+    int sockets[2];
+    int results[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0 || pipe(results) != 0) {
+        cout << "Cannot create the reader's channels." << endl;
+        return 1;
+    }
+    cout.flush();
+    pid_t reader = fork();
+    if (reader == 0) {
+        close(sockets[0]);
+        close(results[0]);
+        runReplicaReader(table.getName(), numbers, reads, sockets[1], results[1]);
+    }
+    close(sockets[1]);
+    close(results[1]);
+    atomic<bool> stop{false};
+    atomic<uint64_t> posted{0};
+    thread writer([&] {
+        for (size_t i = 0; !stop.load(memory_order_relaxed); ++i) {
+            auto guard = lock_guard<Account>(*bank.findAccount(numbers[i % accountCount]));
+            bank.findAccount(numbers[i % accountCount])->postDeposit(0.01);
+            posted.fetch_add(1, memory_order_relaxed);
+        }
+    });
+    for (uint32_t index; read(sockets[0], &index, sizeof(index)) == sizeof(index) && index < accountCount;) {
+        double balance = 0.0;
+        {
+            auto guard = lock_guard<Account>(*bank.findAccount(numbers[index]));
+            balance = bank.findAccount(numbers[index])->getBalance();
+        }
+        if (write(sockets[0], &balance, sizeof(balance)) != sizeof(balance)) {
+            break;
+        }
+    }
+    ReplicaReaderReport report;
+    bool received = read(results[0], &report, sizeof(report)) == sizeof(report);
+    stop.store(true);
+    writer.join();
+    int status = 0;
+    waitpid(reader, &status, 0);
+    close(sockets[0]);
+    close(results[0]);
+    if (!received) {
+        cout << "The reader process did not report back." << endl;
+        return 1;
+    }
+    cout << "  reader process, while the bank posted " << posted.load() << " deposits:" << endl;
+    cout << "    shared table: " << setprecision(1) << report.readSeconds * 1e9 / report.reads << " ns/read over "
+              << report.reads << " reads, " << report.retries << " retries, " << report.inconsistent
+              << " inconsistent, " << report.missing << " missing" << endl;
+    cout << "    socket round-trip: " << report.roundTripSeconds * 1e9 / report.roundTrips << " ns/read over "
+              << report.roundTrips << " reads" << endl;
+    return report.inconsistent == 0 && report.missing == 0 ? 0 : 1;
+}
+
+// Dispatches `bank_bench <name> [size]`.
+int main(int argc, char* argv[]) {
+    cout << fixed;
+    string name = argc > 1 ? argv[1] : "";
+    if (name == "workload") {
+        if (argc < 3) {
+            cout << "Usage: bank_bench workload <file>" << endl;
+            return 1;
+        }
+        return runRecordedWorkloadBenchmark(argv[2]);
+    }
+    size_t size = argc > 2 ? stoull(argv[2]) : 0;
+    if (name == "accrual") {
+        return runAccrualBenchmark(size ? size : 5000000);
+    }
+    if (name == "replay") {
+        return runReplayBenchmark(size ? size : 1000000);
+    }
+    if (name == "numa") {
+        return runNumaBenchmark(size ? size : 200000);
+    }
+    if (name == "layout") {
+        return runLayoutBenchmark(size ? size : 5000000);
+    }
+    if (name == "jobs") {
+        return runJobsBenchmark(size ? size : 200000);
+    }
+    if (name == "lookup") {
+        return runLookupBenchmark(size ? size : 10000000);
+    }
+    if (name == "schedule") {
+        return runScheduleBenchmark(size ? size : 1000000);
+    }
+    if (name == "deterministic") {
+        return runDeterministicBenchmark(size ? size : 1000000);
+    }
+    if (name == "holds") {
+        return runHoldsBenchmark(size ? size : 1000000);
+    }
+    if (name == "ach") {
+        return runAchBenchmark(size ? size : 10000000);
+    }
+    if (name == "filter") {
+        return runFilterBenchmark(size ? size : 1000000);
+    }
+    if (name == "profiles") {
+        return runProfilesBenchmark(size ? size : 1000000);
+    }
+    if (name == "migration") {
+        return runMigrationBenchmark(size ? size : 200000);
+    }
+    if (name == "replication") {
+        return runReplicationBenchmark(size ? size : 1000000);
+    }
+    if (name == "replicas") {
+        return runReplicasBenchmark(size ? size : 2000000);
+    }
+    if (name == "relations") {
+        return runRelationsBenchmark(size ? size : 200000);
+    }
+    if (name == "flowtrace") {
+        return runFlowTraceBenchmark(size ? size : 100000000);
+    }
+    if (name == "anomaly") {
+        return runAnomalyBenchmark(size ? size : 4000000);
+    }
+    if (name == "ratelimit") {
+        return runRateLimitBenchmark(size ? size : 1000000);
+    }
+    cout << "Unknown benchmark '" << name << "'. Available: accrual, replay, numa, layout, jobs, lookup, schedule, "
+              << "deterministic, holds, ach, filter, profiles, migration, replication, replicas, relations, flowtrace, anomaly, ratelimit, workload <file>" << endl;
+    return 1;
+}
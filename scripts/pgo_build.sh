@@ -0,0 +1,125 @@
+#!/usr/bin/env bash
+# Profile-guided optimization pipeline.
+#
+#   1. Baseline build (no PGO), used as the reference.
+#   2. Instrumented build (BANK_PGO=GENERATE).
+#   3. Training run: workloads of deposits, withdrawals, transfers and interest runs from
+#      the workload generator, replayed through the console Bank (the same path as the
+#      validation chains in transferFunds and CheckingAccount::withdraw) by both bank1 and
+#      bank_bench. Most of the bank is inline header code compiled into each binary, so
+#      each binary is trained on the workload itself.
+#   4. Optimized rebuild of the same tree (BANK_PGO=USE) from the collected profiles.
+#   5. Speedup report: the benchmark suite is run on both builds and the best of
+#      REPEAT wall times per benchmark is compared.
+#
+# Usage: scripts/pgo_build.sh            (run from anywhere; writes into $BUILD_DIR)
+# Environment:
+#   BUILD_DIR    output directory (default: build-pgo in the source tree)
+#   TRAIN_OPS    operations per training workload (default: 2000000)
+#   TRAIN_SEEDS  training workload seeds; they differ from the benchmarks' seed (default: "101 202")
+#   REPEAT       runs per benchmark and build (default: 3)
+#   BENCHMARKS   "name:size" list to report on (default: see below)
+#   JOBS         parallel build jobs (default: nproc)
+#   CMAKE_ARGS   extra arguments for every configure (e.g. -DBANK_ENABLE_LTO=ON)
+set -euo pipefail
+
+SOURCE_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="${BUILD_DIR:-$SOURCE_DIR/build-pgo}"
+TRAIN_OPS="${TRAIN_OPS:-2000000}"
+TRAIN_SEEDS="${TRAIN_SEEDS:-101 202}"
+REPEAT="${REPEAT:-3}"
+JOBS="${JOBS:-$(nproc 2>/dev/null || echo 2)}"
+BENCHMARKS="${BENCHMARKS:-replay:1000000 profiles:300000 schedule:500000 lookup:2000000 holds:500000 ach:2000000 filter:500000 accrual:2000000}"
+read -r -a EXTRA_ARGS <<< "${CMAKE_ARGS:-}"
+
+BASELINE="$BUILD_DIR/baseline"
+OPTIMIZED="$BUILD_DIR/optimized"
+PROFILES="$BUILD_DIR/profiles"
+REPORT="$BUILD_DIR/pgo-report.txt"
+
+step() { echo; echo "=== $* ==="; }
+
+configure() { # <dir> <pgo mode>
+    cmake -S "$SOURCE_DIR" -B "$1" -DCMAKE_BUILD_TYPE=Release -DBANK_BUILD_TESTS=OFF \
+          -DBANK_PGO="$2" -DBANK_PGO_DIR="$PROFILES" "${EXTRA_ARGS[@]}" > /dev/null
+}
+
+build() { # <dir>
+    cmake --build "$1" -j "$JOBS" > /dev/null
+}
+
+step "Baseline build"
+configure "$BASELINE" OFF
+build "$BASELINE"
+
+step "Instrumented build"
+rm -rf "$PROFILES"
+mkdir -p "$PROFILES"
+configure "$OPTIMIZED" GENERATE
+cmake --build "$OPTIMIZED" --target clean > /dev/null
+build "$OPTIMIZED"
+
+step "Training run"
+for seed in $TRAIN_SEEDS; do
+    workload="$BUILD_DIR/train-$seed.workload"
+    "$BASELINE/bank1" --workload generate "$workload" "$TRAIN_OPS" "$seed"
+    "$OPTIMIZED/bank1" --workload replay "$workload"
+    "$OPTIMIZED/bank_bench" workload "$workload"
+done
+"$OPTIMIZED/bank1" > /dev/null # The demo covers holds, ACH, FX and bulk jobs
+
+compiler="$(sed -n 's/^CMAKE_CXX_COMPILER_ID:[A-Z]*=//p' "$OPTIMIZED/CMakeCache.txt")"
+if [ -z "$compiler" ]; then
+    compiler="$("${CXX:-c++}" --version | head -n 1)"
+fi
+if [[ "$compiler" == *Clang* || "$compiler" == *clang* ]]; then
+    llvm-profdata merge -o "$PROFILES/bank.profdata" "$PROFILES"/*.profraw
+    echo "Merged $(ls "$PROFILES"/*.profraw | wc -l) raw profile(s)"
+else
+    count="$(find "$PROFILES" -name '*.gcda' | wc -l)"
+    if [ "$count" -eq 0 ]; then
+        echo "No profiles were written to $PROFILES" >&2
+        exit 1
+    fi
+    echo "Collected $count profile file(s)"
+fi
+
+step "Optimized build"
+configure "$OPTIMIZED" USE
+cmake --build "$OPTIMIZED" --target clean > /dev/null
+build "$OPTIMIZED"
+
+# Best wall time of REPEAT runs of one benchmark, in seconds.
+best_time() { # <build dir> <name> <size>
+    local best="" start end elapsed
+    for _ in $(seq "$REPEAT"); do
+        start="$(date +%s.%N)"
+        "$1/bank_bench" "$2" "$3" > /dev/null
+        end="$(date +%s.%N)"
+        elapsed="$(awk -v s="$start" -v e="$end" 'BEGIN { printf "%.3f", e - s }')"
+        if [ -z "$best" ] || awk -v a="$elapsed" -v b="$best" 'BEGIN { exit !(a < b) }'; then
+            best="$elapsed"
+        fi
+    done
+    echo "$best"
+}
+
+step "Speedup report (best of $REPEAT)"
+{
+    printf "%-24s %12s %12s %9s\n" "benchmark" "baseline s" "pgo s" "speedup"
+    total_base=0
+    total_pgo=0
+    for entry in $BENCHMARKS; do
+        name="${entry%%:*}"
+        size="${entry#*:}"
+        base="$(best_time "$BASELINE" "$name" "$size")"
+        pgo="$(best_time "$OPTIMIZED" "$name" "$size")"
+        total_base="$(awk -v a="$total_base" -v b="$base" 'BEGIN { print a + b }')"
+        total_pgo="$(awk -v a="$total_pgo" -v b="$pgo" 'BEGIN { print a + b }')"
+        printf "%-24s %12s %12s %8.2fx\n" "$name $size" "$base" "$pgo" "$(awk -v a="$base" -v b="$pgo" 'BEGIN { print a / b }')"
+    done
+    printf "%-24s %12.3f %12.3f %8.2fx\n" "total" "$total_base" "$total_pgo" \
+           "$(awk -v a="$total_base" -v b="$total_pgo" 'BEGIN { print a / b }')"
+} | tee "$REPORT"
+echo
+echo "Report written to $REPORT; optimized binaries are in $OPTIMIZED"
@@ -0,0 +1,572 @@
+#include "bank.h"
+
+// --- Helper Function for Formatting Time (for Transaction History) ---
+
+string formatDateTime(time_t when) {
+    tm local_tm;
+    localtime_r(&when, &local_tm); // Use local time; the _r form is safe on worker threads
+
+    stringstream ss;
+    ss << put_time(&local_tm, "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+// --- DSA: Transaction Struct ---
+
+const char* transactionTypeName(TransactionType type) {
+    switch (type) {
+        case TransactionType::Deposit: return "Deposit";
+        case TransactionType::Withdrawal: return "Withdrawal";
+        case TransactionType::InterestApplied: return "Interest Applied";
+    }
+    return "Unknown";
+}
+
+// --- Operation Outcomes ---
+
+const char* opStatusDescription(OpStatus status) {
+    switch (status) {
+        case OpStatus::Ok: return "ok";
+        case OpStatus::InvalidAmount: return "invalid amount";
+        case OpStatus::AccountInactive: return "account is not active";
+        case OpStatus::InsufficientFunds: return "insufficient funds";
+        case OpStatus::OverdraftExceeded: return "exceeds overdraft limit";
+        case OpStatus::HoldNotFound: return "no such hold";
+        case OpStatus::HoldsOutstanding: return "authorization holds outstanding";
+        case OpStatus::ItemsPending: return "ACH items pending";
+        case OpStatus::BalanceNotZero: return "balance is not zero";
+    }
+    return "unknown";
+}
+
+// --- Account Lifecycle ---
+
+string accountStatusName(AccountStatus status) {
+    switch (status) {
+        case AccountStatus::Active: return "Active";
+        case AccountStatus::Frozen: return "Frozen";
+        case AccountStatus::Closed: return "Closed";
+    }
+    return "Unknown";
+}
+
+// --- Currencies and Foreign Exchange ---
+
+string currencyCode(Currency currency) {
+    switch (currency) {
+        case Currency::USD: return "USD";
+        case Currency::EUR: return "EUR";
+        case Currency::GBP: return "GBP";
+        case Currency::JPY: return "JPY";
+        case Currency::INR: return "INR";
+    }
+    return "???";
+}
+
+bool parseCurrency(const string& code, Currency& currency) {
+    for (size_t c = 0; c < kCurrencyCount; ++c) {
+        if (currencyCode(static_cast<Currency>(c)) == code) {
+            currency = static_cast<Currency>(c);
+            return true;
+        }
+    }
+    return false;
+}
+
+// --- FX Conversion Kernels ---
+
+void fxConvertKernel(const FxRateSnapshot& rates, const double* amounts,
+                     const uint8_t* fromCurrency, const uint8_t* toCurrency,
+                     double* out, size_t count) {
+    double toBase[kCurrencyCount];
+    double fromBase[kCurrencyCount];
+    for (size_t c = 0; c < kCurrencyCount; ++c) {
+        toBase[c] = rates.toBase[c];
+        fromBase[c] = rates.toBase[c] > 0.0 ? 1.0 / rates.toBase[c] : 0.0;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = amounts[i] * toBase[fromCurrency[i]] * fromBase[toCurrency[i]];
+    }
+}
+
+double fxTotalKernel(const FxRateSnapshot& rates, const double* amounts,
+                     const uint8_t* currencies, size_t count, Currency target) {
+    double total = 0.0;
+    for (size_t c = 0; c < kCurrencyCount; ++c) {
+        const uint8_t code = static_cast<uint8_t>(c);
+        double lanes[4] = {0.0, 0.0, 0.0, 0.0};
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            for (size_t lane = 0; lane < 4; ++lane) {
+                lanes[lane] += currencies[i + lane] == code ? amounts[i + lane] : 0.0;
+            }
+        }
+        double subtotal = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        for (; i < count; ++i) {
+            subtotal += currencies[i] == code ? amounts[i] : 0.0;
+        }
+        if (subtotal != 0.0) {
+            total += subtotal * rates.rate(static_cast<Currency>(c), target);
+        }
+    }
+    return total;
+}
+
+// --- Interest Calculation Engine ---
+
+int daysFromCivil(int year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int>(dayOfEra) - 719468;
+}
+
+void civilFromDays(int dayNumber, int& year, unsigned& month, unsigned& day) {
+    dayNumber += 719468;
+    const int era = (dayNumber >= 0 ? dayNumber : dayNumber - 146096) / 146097;
+    const unsigned dayOfEra = static_cast<unsigned>(dayNumber - era * 146097);
+    const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned monthPart = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * monthPart + 2) / 5 + 1;
+    month = monthPart < 10 ? monthPart + 3 : monthPart - 9;
+    year = static_cast<int>(yearOfEra) + era * 400 + (month <= 2);
+}
+
+int currentDayNumber() {
+    time_t now = chrono::system_clock::to_time_t(chrono::system_clock::now());
+    tm* local_tm = localtime(&now);
+    return daysFromCivil(local_tm->tm_year + 1900, local_tm->tm_mon + 1, local_tm->tm_mday);
+}
+
+// --- NUMA Topology and Placement ---
+
+vector<int> parseCpuList(const string& text) {
+    vector<int> cpus;
+    stringstream ss(text);
+    string range;
+    while (getline(ss, range, ',')) {
+        if (range.empty() || !isdigit(static_cast<unsigned char>(range[0]))) {
+            continue;
+        }
+        size_t dash = range.find('-');
+        int first = stoi(range.substr(0, dash));
+        int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+bool pinCurrentThreadToNode(const NumaTopology& topology, int node) {
+    tlsNumaNode = node;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : topology.nodeCpus[node]) {
+        CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)topology;
+    return false;
+#endif
+}
+
+int nodeOfAddress(const void* addr) {
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+    const unsigned long kMpolFNode = 1, kMpolFAddr = 2; // <numaif.h> MPOL_F_NODE | MPOL_F_ADDR
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, addr, kMpolFNode | kMpolFAddr) == 0) {
+        return node;
+    }
+#else
+    (void)addr;
+#endif
+    return -1;
+}
+
+// --- Work-Stealing Thread Pool ---
+
+thread_local ThreadPool* ThreadPool::tlsPool = nullptr;
+thread_local size_t ThreadPool::tlsWorkerIndex = 0;
+thread_local bool ThreadPool::tlsTaskStolen = false;
+
+// --- Negative Lookup Filters ---
+
+uint64_t hashString(const string& key) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (char c : key) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    hash ^= hash >> 32;
+    hash *= 0x9E3779B97F4A7C15ULL;
+    return hash ^ (hash >> 29);
+}
+
+// --- Shared-Memory Balance Replicas ---
+
+const uint64_t kBalanceTableMagic = 0x42414C5441424C31ULL; // "BALTABL1"
+
+// Bytes mapped for a table with `capacity` slots (the header takes one cache line).
+static size_t balanceTableBytes(size_t capacity) {
+    size_t header = (sizeof(SharedBalanceTable::Header) + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+    return header + capacity * sizeof(BalanceSlot);
+}
+
+SharedBalanceTable::SharedBalanceTable(const string& name, size_t accounts) : _name(name), _owner(true) {
+    size_t capacity = 64;
+    while (capacity < accounts + accounts / 2) { // Load factor at most 2/3 keeps probes short
+        capacity *= 2;
+    }
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw runtime_error("Cannot create shared balance table " + name + ".");
+    }
+    _mappedBytes = balanceTableBytes(capacity);
+    if (ftruncate(fd, static_cast<off_t>(_mappedBytes)) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw runtime_error("Cannot size shared balance table " + name + ".");
+    }
+    _mapping = mmap(nullptr, _mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (_mapping == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw runtime_error("Cannot map shared balance table " + name + ".");
+    }
+    // The new object is zero-filled, which is what every slot and counter starts as.
+    _header = static_cast<Header*>(_mapping);
+    _slots = reinterpret_cast<BalanceSlot*>(static_cast<char*>(_mapping) + balanceTableBytes(0));
+    _header->slotSize = sizeof(BalanceSlot);
+    _header->capacity = capacity;
+    atomic_thread_fence(memory_order_release);
+    _header->magic = kBalanceTableMagic; // Written last: readers check it before anything else
+}
+
+SharedBalanceTable::SharedBalanceTable(const string& name) : _name(name), _owner(false) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw runtime_error("Shared balance table " + name + " does not exist.");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < balanceTableBytes(0)) {
+        close(fd);
+        throw runtime_error("Shared balance table " + name + " is not initialized.");
+    }
+    _mappedBytes = static_cast<size_t>(info.st_size);
+    _mapping = mmap(nullptr, _mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (_mapping == MAP_FAILED) {
+        throw runtime_error("Cannot map shared balance table " + name + ".");
+    }
+    _header = static_cast<Header*>(_mapping);
+    _slots = reinterpret_cast<BalanceSlot*>(static_cast<char*>(_mapping) + balanceTableBytes(0));
+    if (_header->magic != kBalanceTableMagic || _header->slotSize != sizeof(BalanceSlot)
+        || balanceTableBytes(_header->capacity) > _mappedBytes) {
+        munmap(_mapping, _mappedBytes);
+        throw runtime_error("Shared balance table " + name + " has an incompatible layout.");
+    }
+}
+
+SharedBalanceTable::~SharedBalanceTable() {
+    munmap(_mapping, _mappedBytes);
+    if (_owner) {
+        shm_unlink(_name.c_str());
+    }
+}
+
+BalanceSlot* SharedBalanceTable::probe(const string& accountNumber, bool& found) const {
+    found = false;
+    const size_t mask = _header->capacity - 1;
+    for (size_t i = hashString(accountNumber) & mask, probes = 0; probes <= mask; i = (i + 1) & mask, ++probes) {
+        if (_slots[i].isEmpty()) {
+            return &_slots[i]; // The account is not in the table; this is where it would go
+        }
+        if (_slots[i].holds(accountNumber)) {
+            found = true;
+            return &_slots[i];
+        }
+    }
+    return nullptr;
+}
+
+BalanceSlot* SharedBalanceTable::claim(const string& accountNumber) {
+    if (!_owner || accountNumber.size() >= sizeof(BalanceSnapshot::accountNumber)) {
+        return nullptr;
+    }
+    bool found = false;
+    BalanceSlot* slot = probe(accountNumber, found);
+    if (found || !slot || size() + 1 > _header->capacity * 2 / 3) {
+        return found ? slot : nullptr;
+    }
+    BalanceSnapshot keyed = {};
+    memcpy(keyed.accountNumber, accountNumber.c_str(), accountNumber.size() + 1);
+    slot->publish(keyed, nullptr); // Keyed from now on; the account publishes its state next
+    _header->used.fetch_add(1, memory_order_release);
+    return slot;
+}
+
+bool SharedBalanceTable::read(const string& accountNumber, BalanceSnapshot& snapshot, uint64_t* retries) const {
+    bool found = false;
+    BalanceSlot* slot = probe(accountNumber, found);
+    return found && slot->read(snapshot, retries);
+}
+
+// --- Transfer Graph ---
+
+namespace {
+
+uint32_t graphDate(time_t when) {
+    return static_cast<uint32_t>(min<time_t>(max<time_t>(when, 0), numeric_limits<uint32_t>::max()));
+}
+
+} // namespace
+
+void TransferGraph::buildIndex(ThreadPool* pool) {
+    // DSA: Counting sort of the log by source. Scattering in log order keeps each row in
+    // log order, which is date order unless the clock stepped back.
+    const size_t vertices = _vertexCount;
+    const size_t edges = _edges.size();
+    _rowStart.assign(vertices + 1, 0);
+    for (const TransferEdge& edge : _edges) {
+        ++_rowStart[edge.from + 1];
+    }
+    for (size_t v = 0; v < vertices; ++v) {
+        _rowStart[v + 1] += _rowStart[v];
+    }
+    _out.resize(edges);
+    vector<uint32_t> next(_rowStart.begin(), _rowStart.end() - 1);
+    for (size_t i = 0; i < edges; ++i) {
+        const TransferEdge& edge = _edges[i];
+        _out[next[edge.from]++] = {edge.to, edge.date, static_cast<uint32_t>(i + 1)};
+    }
+    vector<uint32_t>().swap(next);
+    auto sortRows = [&](size_t begin, size_t end) {
+        auto byDate = [](const OutEdge& a, const OutEdge& b) { return a.date < b.date; };
+        for (size_t v = begin; v < end; ++v) {
+            auto first = _out.begin() + _rowStart[v], last = _out.begin() + _rowStart[v + 1];
+            if (!is_sorted(first, last, byDate)) {
+                stable_sort(first, last, byDate);
+            }
+        }
+    };
+    if (pool) {
+        pool->parallelFor("transfer index", vertices, 4096, sortRows);
+    } else {
+        sortRows(0, vertices);
+    }
+    _indexed = edges;
+}
+
+FlowTrace TransferGraph::trace(uint32_t start, unsigned hops, time_t fromDate, time_t toDate, ThreadPool* pool) {
+    FlowTrace result;
+    hops = min(hops, 255u);
+    if (start >= _vertexCount || hops == 0 || fromDate > toDate) {
+        return result;
+    }
+    if ((_edges.size() - _indexed) * 4 > _indexed) {
+        buildIndex(pool);
+    }
+    if (_stampCount < _vertexCount) {
+        _stamps.reset(new atomic<uint32_t>[_vertexCount]()); // Fresh stamps are 0, never an epoch
+        _stampCount = _vertexCount;
+        _depth.resize(_vertexCount);
+    }
+    if (++_epoch == 0) { // Wrapped: clear the stamps once every 2^32 traces
+        for (size_t v = 0; v < _stampCount; ++v) {
+            _stamps[v].store(0, memory_order_relaxed);
+        }
+        _epoch = 1;
+    }
+    const uint32_t low = graphDate(fromDate), high = graphDate(toDate);
+    const size_t rows = _rowStart.empty() ? 0 : _rowStart.size() - 1;
+
+    vector<uint32_t> frontier{start};
+    claim(start);
+    _depth[start] = 0;
+    mutex mergeLock;
+    for (unsigned level = 1; level <= hops && !frontier.empty(); ++level) {
+        const size_t firstNew = result.accounts.size();
+        auto expand = [&](size_t begin, size_t end) {
+            vector<uint32_t> reached, via;
+            size_t scanned = 0;
+            for (size_t k = begin; k < end; ++k) {
+                uint32_t account = frontier[k];
+                if (account >= rows) {
+                    continue; // No indexed transfers out of it
+                }
+                auto last = _out.begin() + _rowStart[account + 1];
+                auto it = lower_bound(_out.begin() + _rowStart[account], last, low,
+                                      [](const OutEdge& edge, uint32_t date) { return edge.date < date; });
+                for (; it != last && it->date <= high; ++it) {
+                    ++scanned;
+                    if (claim(it->to)) {
+                        _depth[it->to] = static_cast<uint8_t>(level);
+                        reached.push_back(it->to);
+                        via.push_back(it->id);
+                    }
+                }
+            }
+            lock_guard<mutex> guard(mergeLock);
+            result.accounts.insert(result.accounts.end(), reached.begin(), reached.end());
+            result.via.insert(result.via.end(), via.begin(), via.end());
+            result.edgesScanned += scanned;
+        };
+        if (pool && frontier.size() > 256) {
+            pool->parallelFor("flow trace", frontier.size(), 256, expand);
+        } else {
+            expand(0, frontier.size());
+        }
+        // Transfers logged since the index was built leave accounts reached at the last level.
+        for (size_t i = _indexed; i < _edges.size(); ++i) {
+            const TransferEdge& edge = _edges[i];
+            if (edge.date < low || edge.date > high || _stamps[edge.from].load(memory_order_relaxed) != _epoch
+                || _depth[edge.from] != level - 1) {
+                continue;
+            }
+            ++result.edgesScanned;
+            if (claim(edge.to)) {
+                _depth[edge.to] = static_cast<uint8_t>(level);
+                result.accounts.push_back(edge.to);
+                result.via.push_back(static_cast<uint32_t>(i + 1));
+            }
+        }
+        frontier.assign(result.accounts.begin() + firstNew, result.accounts.end());
+        result.hops.resize(result.accounts.size(), static_cast<uint8_t>(level));
+    }
+    return result;
+}
+
+// --- Request Rate Limiting ---
+
+void RateLimiter::configure(const RateLimit& perAccount, const RateLimit& perCustomer) {
+    auto interval = [](const RateLimit& limit) {
+        return limit.rate > 0 ? max<int64_t>(1, llround(1e9 / limit.rate)) : 0;
+    };
+    _accountInterval = interval(perAccount);
+    _accountTolerance = llround(_accountInterval * max(1.0, perAccount.burst));
+    _customerInterval = interval(perCustomer);
+    _customerTolerance = llround(_customerInterval * max(1.0, perCustomer.burst));
+    _accounts.reset();
+    _capacity = _mask = _size = 0;
+    _customerDue.reset();
+    _customerCapacity = 0;
+    _customerIndex.clear();
+    _freeCustomers.clear();
+}
+
+void RateLimiter::grow() {
+    unique_ptr<Bucket[]> old = move(_accounts);
+    size_t oldCapacity = _capacity;
+    _capacity = oldCapacity ? oldCapacity * 2 : 64;
+    _mask = _capacity - 1;
+    _accounts.reset(new Bucket[_capacity]);
+    for (size_t i = 0; i < oldCapacity; ++i) {
+        if (old[i].key) {
+            size_t pos = old[i].key & _mask;
+            while (_accounts[pos].key) {
+                pos = (pos + 1) & _mask;
+            }
+            _accounts[pos].key = old[i].key;
+            _accounts[pos].customer = old[i].customer;
+            _accounts[pos].due.store(old[i].due.load(memory_order_relaxed), memory_order_relaxed);
+        }
+    }
+}
+
+void RateLimiter::addCustomer(const string& customerId) {
+    uint64_t key = keyOf(customerId);
+    if (_customerIndex.count(key)) {
+        return;
+    }
+    uint32_t index;
+    if (!_freeCustomers.empty()) {
+        index = _freeCustomers.back();
+        _freeCustomers.pop_back();
+    } else {
+        index = static_cast<uint32_t>(_customerIndex.size());
+        if (index == _customerCapacity) {
+            size_t capacity = _customerCapacity ? _customerCapacity * 2 : 64;
+            unique_ptr<atomic<int64_t>[]> due(new atomic<int64_t>[capacity]);
+            for (size_t i = 0; i < _customerCapacity; ++i) {
+                due[i].store(_customerDue[i].load(memory_order_relaxed), memory_order_relaxed);
+            }
+            _customerDue = move(due);
+            _customerCapacity = capacity;
+        }
+    }
+    _customerDue[index].store(0, memory_order_relaxed);
+    _customerIndex.emplace(key, index);
+}
+
+void RateLimiter::addAccount(const string& accountNumber, const string& ownerId) {
+    uint64_t key = keyOf(accountNumber);
+    if (find(key)) {
+        return;
+    }
+    if ((_size + 1) * 2 > _capacity) {
+        grow();
+    }
+    size_t pos = key & _mask;
+    while (_accounts[pos].key) {
+        pos = (pos + 1) & _mask;
+    }
+    auto owner = _customerIndex.find(keyOf(ownerId));
+    _accounts[pos].key = key;
+    _accounts[pos].customer = owner != _customerIndex.end() ? owner->second : kNoCustomer;
+    _accounts[pos].due.store(0, memory_order_relaxed);
+    ++_size;
+}
+
+bool RateLimiter::eraseAccount(const string& accountNumber) {
+    Bucket* found = find(keyOf(accountNumber));
+    if (!found) {
+        return false;
+    }
+    size_t pos = static_cast<size_t>(found - _accounts.get());
+    for (size_t next = (pos + 1) & _mask; _accounts[next].key; next = (next + 1) & _mask) {
+        size_t home = _accounts[next].key & _mask;
+        // Move the entry back if its home does not lie cyclically in (pos, next].
+        if (((next - home) & _mask) >= ((next - pos) & _mask)) {
+            _accounts[pos].key = _accounts[next].key;
+            _accounts[pos].customer = _accounts[next].customer;
+            _accounts[pos].due.store(_accounts[next].due.load(memory_order_relaxed), memory_order_relaxed);
+            pos = next;
+        }
+    }
+    _accounts[pos].key = 0;
+    --_size;
+    return true;
+}
+
+bool RateLimiter::eraseCustomer(const string& customerId) {
+    auto it = _customerIndex.find(keyOf(customerId));
+    if (it == _customerIndex.end()) {
+        return false;
+    }
+    _freeCustomers.push_back(it->second);
+    _customerIndex.erase(it);
+    return true;
+}
+
+// --- Bank Build Profiles ---
+
+const char* bankOpName(BankOp op) {
+    switch (op) {
+        case BankOp::AddCustomer: return "add customer";
+        case BankOp::OpenAccount: return "open account";
+        case BankOp::Deposit: return "deposit";
+        case BankOp::Withdrawal: return "withdrawal";
+        case BankOp::Transfer: return "transfer";
+        case BankOp::Lifecycle: return "lifecycle";
+        case BankOp::Hold: return "hold";
+        case BankOp::Ach: return "ach";
+        case BankOp::Batch: return "batch";
+    }
+    return "unknown";
+}
@@ -0,0 +1,4506 @@
+// Core of the online banking system: transactions, accounts, customers and the bank,
+// with the FX, interest, concurrency and lookup machinery they use. Built as the
+// `bank` library (see CMakeLists.txt); the demo, tests and benchmarks link it.
+#ifndef BANK_H
+#define BANK_H
+
+#include <iostream> // For input/output operations
+#include <string>   // For string manipulation
+#include <vector>   // For dynamic arrays (transaction history)
+#include <map>      // For key-value pairs (customers, accounts)
+#include <memory>   // For smart pointers (shared_ptr for memory management)
+#include <stdexcept> // For standard exceptions (e.g., ValueError)
+#include <iomanip>  // For output formatting (e.g., setprecision)
+#include <chrono>   // For date and time
+#include <ctime>    // For time_t and tm structures
+#include <sstream>  // For string stream operations
+#include <cmath>    // For fabs (balance checks)
+#include <array>    // For fixed-size rate tables
+#include <cstdint>  // For fixed-width integer types
+#include <limits>   // For numeric_limits
+#include <algorithm> // For min/max
+#include <random>   // For synthetic benchmark data and workloads
+#include <fstream>  // For recorded workload files
+#include <cstdlib>  // For strtod/strtoull (CSV import, journal replay)
+#include <thread>   // For shard worker threads
+#include <atomic>   // For spin locks
+#include <mutex>    // For shard work queues
+#include <condition_variable> // For waking shard workers
+#include <deque>    // For shard work queues
+#include <functional> // For queued tasks
+#include <future>   // For waiting on shard tasks
+#include <cctype>   // For isdigit (CPU list parsing)
+#include <unordered_map> // For transfer conflict scheduling
+#include <unordered_set> // For accounts mid-migration
+#include <cstring>       // For memcpy (shared balance slots)
+#include <shared_mutex>  // For the concurrent bank profile
+#include <fcntl.h>       // For shm_open flags (shared balance table)
+#include <sys/mman.h>    // For shm_open and mmap (shared balance table)
+#include <sys/stat.h>    // For fstat (shared balance table)
+#include <unistd.h>      // For syscall, ftruncate and close
+#ifdef __linux__
+#include <sched.h>       // For sched_setaffinity (thread pinning)
+#include <sys/syscall.h> // For SYS_get_mempolicy (NUMA page queries)
+#endif
+
+// Use the std namespace as requested
+using namespace std;
+
+// --- Forward Declarations ---
+// Forward declarations are needed because Bank and Customer classes
+// will refer to each other or to Account before their full definitions.
+class Account;
+class SavingsAccount;
+class CheckingAccount;
+class Customer;
+template <class Threading, class Persistence, class Instrumentation, class Logging>
+class BasicBank;
+
+// --- Helper Function for Formatting Time (for Transaction History) ---
+// Transactions store a raw time_t when posted; it is only formatted when printed.
+string formatDateTime(time_t when);
+
+// Returns the wall-clock seconds taken by fn() (for replays and benchmarks).
+template <class Fn>
+double timeSeconds(Fn&& fn) {
+    auto start = chrono::steady_clock::now();
+    fn();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Monotonic clock reading in nanoseconds. On Linux the steady clock is shared by every
+// process on the machine, so readings taken by different processes can be compared.
+inline int64_t steadyNanos() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The same clock read at the resolution of the kernel's tick (a few milliseconds), which
+// is several times cheaper, for callers that need no more, such as rate limits.
+inline int64_t coarseSteadyNanos() {
+#ifdef CLOCK_MONOTONIC_COARSE
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    return int64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+    return steadyNanos();
+#endif
+}
+
+// --- DSA: Transaction Struct ---
+// Kinds of entries in an account's transaction history.
+enum class TransactionType : uint8_t { Deposit, Withdrawal, InterestApplied };
+
+// Returns the display name for a transaction type.
+const char* transactionTypeName(TransactionType type);
+
+// Represents a single transaction record.
+// Holds no strings, so posting one never allocates beyond the history vector itself.
+// When non-zero, transactions posted by this thread are stamped with this time instead of
+// the clock, so deterministic replays produce identical histories (see Deterministic Execution).
+inline thread_local time_t tlsTransactionTime = 0;
+
+struct Transaction {
+    TransactionType type;
+    bool anomalous; // Flagged by the account's anomaly detector (see Streaming Anomaly Detection)
+    double amount;
+    time_t date;
+    double newBalance;
+
+    // Constructor for easy initialization
+    Transaction(TransactionType type, double amount, double newBalance, bool anomalous = false)
+        : type(type), anomalous(anomalous), amount(amount),
+          date(tlsTransactionTime ? tlsTransactionTime : time(nullptr)), newBalance(newBalance) {}
+
+    // Method to print transaction details
+    void print(ostream& out = cout) const {
+        out << "  - " << formatDateTime(date) << " | Type: " << transactionTypeName(type)
+                  << " | Amount: $" << fixed << setprecision(2) << amount
+                  << " | New Balance: $" << newBalance << (anomalous ? " | Flagged" : "") << endl;
+    }
+};
+
+// --- Streaming Anomaly Detection ---
+// Every account keeps an exponentially weighted mean and variance of its deposit amounts
+// and, separately, of its withdrawal amounts. Each posting updates its stream in O(1), a
+// few multiply-adds with no history scan, and is flagged on its transaction record if it
+// lies more than k standard deviations from the stream's mean before it.
+
+// Postings the averages effectively remember. A stream flags nothing until it has seen
+// this many; until then it keeps the plain mean and variance of what it has seen.
+const uint32_t kAnomalyWindow = 32;
+const double kDefaultAnomalySigmas = 4.0;
+// Smallest standard deviation, as a fraction of the mean: a stream of identical amounts
+// (a salary, a standing order) does not flag a one-cent change.
+const double kAnomalyMinDeviation = 0.01;
+
+// DSA: Incremental exponentially weighted mean and variance (West, 1979). Computed in
+// double but stored as float, so an account's detector state fits in 24 bytes; seven
+// significant digits are plenty for a k-sigma test.
+struct AmountStats {
+    float mean = 0.0f;
+    float variance = 0.0f;
+    uint32_t count = 0; // Postings seen, up to kAnomalyWindow
+
+    // Folds in one amount. Returns true if it lies more than k standard deviations from the
+    // mean before it, given k squared (compared squared, so there is no square root).
+    bool observe(double amount, double sigmasSquared) {
+        double diff = amount - mean;
+        double weight = 1.0 / kAnomalyWindow;
+        bool anomalous = false;
+        if (count < kAnomalyWindow) {
+            weight = 1.0 / ++count; // Equal weights: the plain running mean and variance
+        } else {
+            double floor = kAnomalyMinDeviation * kAnomalyMinDeviation * double(mean) * mean;
+            anomalous = diff * diff > sigmasSquared * max<double>(variance, floor);
+        }
+        mean = static_cast<float>(mean + weight * diff);
+        variance = static_cast<float>((1.0 - weight) * (variance + weight * diff * diff));
+        return anomalous;
+    }
+};
+
+// --- Operation Outcomes ---
+// Result of a core (non-printing) account operation.
+enum class OpStatus : uint8_t {
+    Ok,
+    InvalidAmount,
+    AccountInactive,
+    InsufficientFunds,
+    OverdraftExceeded,
+    HoldNotFound,
+    HoldsOutstanding,
+    ItemsPending,
+    BalanceNotZero,
+};
+
+// Describes a failed OpStatus for console messages.
+const char* opStatusDescription(OpStatus status);
+
+// --- Account Lifecycle ---
+// An account starts Active. A Frozen account rejects all money movement until it is
+// unfrozen, and a Closed account is permanently retired into the bank's archive.
+enum class AccountStatus { Active, Frozen, Closed };
+
+// Returns a readable name for an account status.
+string accountStatusName(AccountStatus status);
+
+// --- Currencies and Foreign Exchange ---
+// Every account holds its balance in a single currency. Amounts moving between accounts
+// of different currencies are converted through the bank's exchange-rate table.
+enum class Currency : uint8_t { USD, EUR, GBP, JPY, INR };
+const size_t kCurrencyCount = 5;
+
+// Returns the ISO code for a currency.
+string currencyCode(Currency currency);
+
+// Parses an ISO code such as "EUR". Returns false for unknown codes.
+bool parseCurrency(const string& code, Currency& currency);
+
+// An amount tagged with the currency it is expressed in.
+struct Money {
+    double amount;
+    Currency currency;
+};
+
+// DSA: Immutable set of exchange rates stored as a flat array indexed by currency.
+// toBase[c] is the value of one unit of currency c in the base currency; 0 means no quote.
+struct FxRateSnapshot {
+    uint64_t version;
+    Currency base;
+    array<double, kCurrencyCount> toBase;
+
+    bool hasRate(Currency currency) const {
+        return toBase[static_cast<size_t>(currency)] > 0.0;
+    }
+
+    // Returns how many units of `to` one unit of `from` buys (0 if either side is unquoted).
+    double rate(Currency from, Currency to) const {
+        if (!hasRate(from) || !hasRate(to)) {
+            return 0.0;
+        }
+        return toBase[static_cast<size_t>(from)] / toBase[static_cast<size_t>(to)];
+    }
+
+    Money convert(const Money& money, Currency to) const {
+        return Money{money.amount * rate(money.currency, to), to};
+    }
+};
+
+// Exchange-rate table with versioned snapshots. Each rate change publishes a new
+// snapshot; a batch holds on to one snapshot so every item in it converts at the same
+// rates, and earlier versions stay cached for auditing.
+class FxRateTable {
+private:
+    vector<shared_ptr<const FxRateSnapshot>> _versions; // DSA: index = version number
+
+public:
+    explicit FxRateTable(Currency base = Currency::USD) {
+        auto first = make_shared<FxRateSnapshot>();
+        first->version = 0;
+        first->base = base;
+        first->toBase.fill(0.0);
+        first->toBase[static_cast<size_t>(base)] = 1.0;
+        _versions.push_back(first);
+    }
+
+    Currency getBaseCurrency() const { return _versions.back()->base; }
+    uint64_t getVersion() const { return _versions.back()->version; }
+
+    // Returns the current rates.
+    shared_ptr<const FxRateSnapshot> snapshot() const { return _versions.back(); }
+
+    // Returns the rates as they were at an earlier version (nullptr if it never existed).
+    shared_ptr<const FxRateSnapshot> snapshot(uint64_t version) const {
+        return version < _versions.size() ? _versions[version] : nullptr;
+    }
+
+    // Quotes a currency against the base currency and publishes a new version.
+    bool setRate(Currency currency, double valueInBase) {
+        const FxRateSnapshot& current = *_versions.back();
+        if (currency == current.base) {
+            cout << "The rate of the base currency is fixed at 1." << endl;
+            return false;
+        }
+        if (valueInBase <= 0) {
+            cout << "Exchange rate must be a positive number." << endl;
+            return false;
+        }
+        auto next = make_shared<FxRateSnapshot>(current);
+        next->version = current.version + 1;
+        next->toBase[static_cast<size_t>(currency)] = valueInBase;
+        _versions.push_back(next);
+        return true;
+    }
+};
+
+// --- FX Conversion Kernels ---
+// These loops work on contiguous arrays (structure-of-arrays) and have branch-free
+// bodies so the compiler can vectorize them (build with -O3, plus -march=native to use
+// the widest SIMD units available). The rate lookups hit a table of kCurrencyCount
+// entries that stays in L1.
+
+// out[i] = amounts[i] converted from currency fromCurrency[i] into toCurrency[i].
+void fxConvertKernel(const FxRateSnapshot& rates, const double* amounts,
+                     const uint8_t* fromCurrency, const uint8_t* toCurrency,
+                     double* out, size_t count);
+
+// Returns the sum of all amounts expressed in the target currency. Amounts are first
+// summed per currency with masked accumulation (one pass per currency, no gathers),
+// then each subtotal is converted once. Four independent partial sums let the compiler
+// keep the adds in SIMD lanes without reassociating floating-point math.
+double fxTotalKernel(const FxRateSnapshot& rates, const double* amounts,
+                     const uint8_t* currencies, size_t count, Currency target);
+
+// --- Interest Calculation Engine ---
+// Interest policies are strategy types chosen at compile time. The bulk accrual loop is
+// a template over the policy, so each policy gets its own specialized loop and nothing
+// inside it branches on which policy (or day-count convention) is in use.
+
+// Converts a civil date to a day number (days since 1970-01-01).
+int daysFromCivil(int year, unsigned month, unsigned day);
+
+// Converts a day number back to a civil date.
+void civilFromDays(int dayNumber, int& year, unsigned& month, unsigned& day);
+
+// Returns today's day number in local time.
+int currentDayNumber();
+
+// The period interest is accrued over: [startDay, endDay) as day numbers.
+struct AccrualPeriod {
+    int startDay;
+    int endDay;
+
+    int days() const { return endDay - startDay; }
+};
+
+// --- Day-Count Conventions ---
+// Each convention turns an accrual period into a year fraction and states how many
+// days make up a year for daily compounding.
+
+// Actual/365 Fixed: actual days over a 365-day year.
+struct Actual365Fixed {
+    static constexpr double kDaysPerYear = 365.0;
+    static const char* name() { return "Actual/365F"; }
+    static double yearFraction(const AccrualPeriod& period) { return period.days() / kDaysPerYear; }
+};
+
+// Actual/360: actual days over a 360-day year (money-market convention).
+struct Actual360 {
+    static constexpr double kDaysPerYear = 360.0;
+    static const char* name() { return "Actual/360"; }
+    static double yearFraction(const AccrualPeriod& period) { return period.days() / kDaysPerYear; }
+};
+
+// 30/360 (US bond basis): every month counts as 30 days.
+struct Thirty360 {
+    static constexpr double kDaysPerYear = 360.0;
+    static const char* name() { return "30/360"; }
+    static double yearFraction(const AccrualPeriod& period) {
+        int y1, y2;
+        unsigned m1, d1, m2, d2;
+        civilFromDays(period.startDay, y1, m1, d1);
+        civilFromDays(period.endDay, y2, m2, d2);
+        if (d1 == 31) d1 = 30;
+        if (d2 == 31 && d1 == 30) d2 = 30;
+        const int days = 360 * (y2 - y1) + 30 * (static_cast<int>(m2) - static_cast<int>(m1))
+                         + (static_cast<int>(d2) - static_cast<int>(d1));
+        return days / 360.0;
+    }
+};
+
+// --- Interest Policies ---
+// A policy is prepared once per accrual pass (so period-wide constants are computed
+// once), then interest(balance, rate) is called per account and must stay branch-free.
+
+// Simple interest on the whole balance for the period.
+template <class DayCount>
+struct SimpleInterestPolicy {
+    double yearFraction = 0.0;
+
+    static string name() { return string("Simple ") + DayCount::name(); }
+    void prepare(const AccrualPeriod& period) { yearFraction = DayCount::yearFraction(period); }
+    double interest(double balance, double annualRate) const {
+        return balance * annualRate * yearFraction;
+    }
+};
+
+// Interest compounded daily over the period.
+template <class DayCount>
+struct DailyCompoundPolicy {
+    double days = 0.0;
+
+    static string name() { return string("Daily compound ") + DayCount::name(); }
+    void prepare(const AccrualPeriod& period) {
+        days = DayCount::yearFraction(period) * DayCount::kDaysPerYear;
+    }
+    double interest(double balance, double annualRate) const {
+        return balance * expm1(days * log1p(annualRate / DayCount::kDaysPerYear));
+    }
+};
+
+// One balance band of a tiered rate schedule: the part of a balance above `floor`
+// (and below the next band's floor) earns `annualRate`.
+struct InterestTier {
+    double floor;
+    double annualRate;
+};
+
+// Tiered simple interest: each slice of the balance earns its band's rate. The
+// account's own rate is added on top as a bonus margin. Band widths are precomputed,
+// and every band is evaluated with min/max so the loop has no data-dependent branches.
+template <class DayCount, size_t kTiers>
+struct TieredRatePolicy {
+    array<InterestTier, kTiers> tiers;
+    array<double, kTiers> widths{};
+    double yearFraction = 0.0;
+
+    explicit TieredRatePolicy(const array<InterestTier, kTiers>& bands) : tiers(bands) {}
+
+    static string name() { return string("Tiered ") + DayCount::name(); }
+    void prepare(const AccrualPeriod& period) {
+        yearFraction = DayCount::yearFraction(period);
+        for (size_t t = 0; t < kTiers; ++t) {
+            widths[t] = t + 1 < kTiers ? tiers[t + 1].floor - tiers[t].floor : numeric_limits<double>::max();
+        }
+    }
+    double interest(double balance, double bonusRate) const {
+        double annual = 0.0;
+        for (size_t t = 0; t < kTiers; ++t) {
+            const double slice = min(max(balance - tiers[t].floor, 0.0), widths[t]);
+            annual += slice * tiers[t].annualRate;
+        }
+        return (annual + max(balance, 0.0) * bonusRate) * yearFraction;
+    }
+};
+
+// Bulk accrual over contiguous arrays: adds interest to every balance and records the
+// amount in interestOut. Instantiated per policy, so the loop body is fully inlined.
+template <class Policy>
+void accrueInterestKernel(const Policy& policy, double* balances, const double* rates,
+                          double* interestOut, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const double interest = policy.interest(balances[i], rates[i]);
+        interestOut[i] = interest;
+        balances[i] += interest;
+    }
+}
+
+// --- Concurrency Primitives ---
+// Size of a cache line on the x86-64 and ARM server parts this bank targets. Fields that
+// different threads write are kept kCacheLineSize apart.
+const size_t kCacheLineSize = 64;
+
+// DSA: Test-and-test-and-set spin lock in a single byte. Spinning reads the flag without
+// writing it, so waiters do not steal the cache line from the holder. Meant for very
+// short critical sections such as one account posting.
+class SpinLock {
+private:
+    atomic<bool> _locked{false};
+
+public:
+    void lock() {
+        while (_locked.exchange(true, memory_order_acquire)) {
+            while (_locked.load(memory_order_relaxed)) {
+                this_thread::yield();
+            }
+        }
+    }
+    bool try_lock() {
+        return !_locked.load(memory_order_relaxed) && !_locked.exchange(true, memory_order_acquire);
+    }
+    void unlock() { _locked.store(false, memory_order_release); }
+};
+
+// --- NUMA Topology and Placement ---
+// On multi-socket machines memory is attached to a NUMA node, and touching another
+// node's memory crosses the socket interconnect. Linux places a page on the node of the
+// thread that first touches it, so the bank places an account by constructing it (and
+// growing its history) on a worker thread pinned to the account's shard node. When the
+// machine has a single node, nodes are emulated by splitting the CPUs so the placement
+// logic and the local/remote accounting still run.
+
+// Parses a sysfs CPU list such as "0-3,8,10-11".
+vector<int> parseCpuList(const string& text);
+
+// The machine's NUMA nodes and the CPUs belonging to each.
+struct NumaTopology {
+    vector<vector<int>> nodeCpus; // DSA: index = node id
+    bool emulated = false;
+
+    size_t nodeCount() const { return nodeCpus.size(); }
+
+    // Reads /sys/devices/system/node. If only one real node exists and emulatedNodes > 1,
+    // the CPUs are dealt round-robin into that many virtual nodes.
+    static NumaTopology detect(size_t emulatedNodes = 2) {
+        NumaTopology topology;
+        for (int node = 0;; ++node) {
+            ifstream in("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+            if (!in) {
+                break;
+            }
+            string text;
+            getline(in, text);
+            topology.nodeCpus.push_back(parseCpuList(text));
+        }
+        if (topology.nodeCpus.empty()) {
+            vector<int> all;
+            for (unsigned cpu = 0; cpu < max(1u, thread::hardware_concurrency()); ++cpu) {
+                all.push_back(static_cast<int>(cpu));
+            }
+            topology.nodeCpus.push_back(all);
+        }
+        if (topology.nodeCpus.size() == 1 && emulatedNodes > 1) {
+            vector<int> all = topology.nodeCpus[0];
+            topology.nodeCpus.assign(emulatedNodes, vector<int>());
+            for (size_t i = 0; i < max(all.size(), emulatedNodes); ++i) {
+                topology.nodeCpus[i % emulatedNodes].push_back(all[i % all.size()]);
+            }
+            topology.emulated = true;
+        }
+        return topology;
+    }
+};
+
+// Node the calling thread was pinned to (-1 if it was never pinned).
+inline thread_local int tlsNumaNode = -1;
+
+// Restricts the calling thread to the CPUs of one node. Returns false if the OS refused.
+bool pinCurrentThreadToNode(const NumaTopology& topology, int node);
+
+// Returns the node backing the page at addr, or -1 if the kernel cannot tell
+// (no NUMA support, or the page is not yet faulted in).
+int nodeOfAddress(const void* addr);
+
+// Timings of one live account migration between shards (see ShardRuntime::migrate).
+struct MigrationStats {
+    string accountNumber;
+    size_t fromShard = 0;
+    size_t toShard = 0;
+    size_t queuedRequests = 0; // Requests on the account held during the handoff, then replayed
+    double drainSeconds = 0.0; // Waiting for requests already in flight on the account
+    double copySeconds = 0.0;  // Relocating the account's state on the target worker
+    double totalSeconds = 0.0; // Handoff start to the queued requests being released
+};
+
+// A worker thread per shard, pinned to the shard's node. Each shard exclusively owns its
+// accounts: all work on them is submitted to that shard's queue and runs on its worker,
+// so the memory they allocate is node-local and no locking between shards is needed.
+//
+// Accounts live on the shard their number hashes to unless they have been migrated.
+// Requests routed by account (route) go through a small routing table that records
+// migrated placements and the requests in flight per account. Migrating one account
+// opens a handoff for it: new requests on that account wait in a handoff queue while
+// earlier ones finish and its state is moved, then are replayed on the new shard in
+// arrival order. A request also waits if one of its accounts already has a request
+// waiting, so requests on an account never overtake each other. Requests on every
+// other account keep flowing throughout.
+class ShardRuntime {
+private:
+    struct Shard {
+        int node = 0;
+        thread worker;
+        mutex lock;
+        condition_variable wake;
+        deque<function<void()>> tasks; // DSA: FIFO work queue
+        size_t running = 0;
+        bool stopping = false;
+    };
+
+    // A request routed by account, with every account it touches.
+    struct RoutedRequest {
+        vector<string> accounts;
+        function<void()> task;
+    };
+
+    NumaTopology _topology;
+    vector<unique_ptr<Shard>> _shards;
+    // Routing table. DSA: Hash maps keyed by account number, all holding only the
+    // exceptions (migrated accounts, busy accounts, accounts mid-handoff), so they stay
+    // small and an unmigrated account routes by its hash.
+    mutable mutex _routingLock;
+    condition_variable _routingChanged;
+    unordered_map<string, size_t> _placements;               // Account -> shard, when not its hash shard
+    unordered_map<string, size_t> _inFlight;   // Account -> routed requests not yet finished
+    unordered_set<string> _handoffs;           // Accounts being migrated
+    unordered_map<string, size_t> _heldCount;  // Account -> requests on it in _held
+    deque<RoutedRequest> _held; // DSA: FIFO of requests waiting for a handoff, in arrival order
+    vector<MigrationStats> _migrations;
+
+    static void workerLoop(const NumaTopology& topology, Shard& shard) {
+        pinCurrentThreadToNode(topology, shard.node);
+        unique_lock<mutex> guard(shard.lock);
+        for (;;) {
+            shard.wake.wait(guard, [&] { return shard.stopping || !shard.tasks.empty(); });
+            if (shard.tasks.empty()) {
+                return; // Stopping and drained
+            }
+            function<void()> task = move(shard.tasks.front());
+            shard.tasks.pop_front();
+            ++shard.running;
+            guard.unlock();
+            task();
+            guard.lock();
+            --shard.running;
+            shard.wake.notify_all();
+        }
+    }
+
+public:
+    // Creates `shardCount` shards spread round-robin over the topology's nodes.
+    ShardRuntime(const NumaTopology& topology, size_t shardCount) : _topology(topology) {
+        if (shardCount == 0) {
+            throw invalid_argument("Shard count must be positive.");
+        }
+        for (size_t i = 0; i < shardCount; ++i) {
+            auto shard = make_unique<Shard>();
+            shard->node = static_cast<int>(i % topology.nodeCount());
+            _shards.push_back(move(shard));
+        }
+        for (auto& shard : _shards) {
+            Shard* raw = shard.get();
+            raw->worker = thread([this, raw] { workerLoop(_topology, *raw); });
+        }
+    }
+
+    ~ShardRuntime() {
+        for (auto& shard : _shards) {
+            lock_guard<mutex> guard(shard->lock);
+            shard->stopping = true;
+            shard->wake.notify_all();
+        }
+        for (auto& shard : _shards) {
+            shard->worker.join();
+        }
+    }
+
+    ShardRuntime(const ShardRuntime&) = delete;
+    ShardRuntime& operator=(const ShardRuntime&) = delete;
+
+    const NumaTopology& getTopology() const { return _topology; }
+    size_t shardCount() const { return _shards.size(); }
+    int nodeOfShard(size_t shard) const { return _shards[shard]->node; }
+
+    // The shard an account number hashes to (FNV-1a), where it lives until migrated.
+    size_t homeShardFor(const string& accountNumber) const {
+        uint64_t hash = 1469598103934665603ULL;
+        for (char c : accountNumber) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+        }
+        return hash % _shards.size();
+    }
+
+    // Maps an account number to its owning shard, following migrations.
+    size_t shardFor(const string& accountNumber) const {
+        lock_guard<mutex> guard(_routingLock);
+        return placementLocked(accountNumber);
+    }
+
+    // Queues a task on a shard's worker.
+    void submit(size_t shard, function<void()> task) {
+        Shard& s = *_shards[shard];
+        lock_guard<mutex> guard(s.lock);
+        s.tasks.push_back(move(task));
+        s.wake.notify_all();
+    }
+
+    // Runs fn on a shard's worker and waits for its result.
+    template <class Fn>
+    auto run(size_t shard, Fn fn) -> decltype(fn()) {
+        packaged_task<decltype(fn())()> task(move(fn));
+        auto result = task.get_future();
+        submit(shard, [&task] { task(); });
+        return result.get();
+    }
+
+    // Waits until every shard's queue is empty and idle. Requests held in a handoff queue
+    // are not waited for; they are released when their migration finishes.
+    void drain() {
+        for (auto& shard : _shards) {
+            unique_lock<mutex> guard(shard->lock);
+            shard->wake.wait(guard, [&] { return shard->tasks.empty() && shard->running == 0; });
+        }
+    }
+
+    // --- Routed requests and live migration ---
+
+    // Queues a request on the shard that owns accounts[0]. The other accounts (e.g. a
+    // transfer's destination) are only tracked, so a migration of any of them waits for
+    // the request; the task must lock accounts owned by other shards itself. If any of
+    // the accounts is being migrated, the request waits in the handoff queue.
+    void route(vector<string> accounts, function<void()> task) {
+        if (accounts.empty()) {
+            throw invalid_argument("A routed request needs at least one account.");
+        }
+        lock_guard<mutex> guard(_routingLock);
+        routeLocked(RoutedRequest{move(accounts), move(task)});
+    }
+
+    // Moves an account to another shard without stopping traffic:
+    //   1. Open a handoff queue; new requests on the account are held there.
+    //   2. Wait for the account's requests already in flight to finish.
+    //   3. Run `relocate` on the target shard's worker (it moves the account's state).
+    //   4. Point the routing table at the target and replay the held requests there.
+    // Returns false if the shard is out of range, the account is already there or
+    // another migration of it is under way.
+    bool migrate(const string& accountNumber, size_t targetShard, const function<void()>& relocate,
+                 MigrationStats* statsOut = nullptr) {
+        MigrationStats stats;
+        stats.accountNumber = accountNumber;
+        stats.toShard = targetShard;
+        auto start = chrono::steady_clock::now();
+        {
+            unique_lock<mutex> guard(_routingLock);
+            if (targetShard >= _shards.size() || _handoffs.count(accountNumber) > 0) {
+                return false;
+            }
+            stats.fromShard = placementLocked(accountNumber);
+            if (stats.fromShard == targetShard) {
+                return false;
+            }
+            _handoffs.insert(accountNumber);
+            stats.drainSeconds = timeSeconds([&] {
+                _routingChanged.wait(guard, [&] { return _inFlight.count(accountNumber) == 0; });
+            });
+        }
+        stats.copySeconds = timeSeconds([&] { run(targetShard, [&] { relocate(); }); });
+        {
+            lock_guard<mutex> guard(_routingLock);
+            if (targetShard == homeShardFor(accountNumber)) {
+                _placements.erase(accountNumber);
+            } else {
+                _placements[accountNumber] = targetShard;
+            }
+            _handoffs.erase(accountNumber);
+            deque<RoutedRequest> held;
+            held.swap(_held);
+            _heldCount.clear();
+            for (RoutedRequest& request : held) {
+                stats.queuedRequests += count(request.accounts.begin(), request.accounts.end(), accountNumber) > 0;
+                routeLocked(move(request)); // Arrival order; may be held again by another handoff
+            }
+            stats.totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            _migrations.push_back(stats);
+        }
+        if (statsOut) {
+            *statsOut = stats;
+        }
+        return true;
+    }
+
+    // Every migration completed so far.
+    vector<MigrationStats> getMigrations() const {
+        lock_guard<mutex> guard(_routingLock);
+        return _migrations;
+    }
+
+private:
+    size_t placementLocked(const string& accountNumber) const {
+        auto placed = _placements.find(accountNumber);
+        return placed != _placements.end() ? placed->second : homeShardFor(accountNumber);
+    }
+
+    // Holds the request if one of its accounts is mid-handoff or already has a request
+    // held; otherwise counts it in flight on every account and submits it. Called with
+    // _routingLock held.
+    void routeLocked(RoutedRequest request) {
+        for (const string& account : request.accounts) {
+            if (_handoffs.count(account) > 0 || _heldCount.count(account) > 0) {
+                for (const string& held : request.accounts) {
+                    ++_heldCount[held];
+                }
+                _held.push_back(move(request));
+                return;
+            }
+        }
+        for (const string& account : request.accounts) {
+            ++_inFlight[account];
+        }
+        size_t shard = placementLocked(request.accounts[0]);
+        submit(shard, [this, request = move(request)] {
+            request.task();
+            lock_guard<mutex> guard(_routingLock);
+            for (const string& account : request.accounts) {
+                auto count = _inFlight.find(account);
+                if (--count->second == 0) {
+                    _inFlight.erase(count);
+                }
+            }
+            _routingChanged.notify_all();
+        });
+    }
+};
+
+// --- Work-Stealing Thread Pool ---
+// Bulk jobs (interest accrual, reconciliation, statements, import/export) run on a
+// pool of workers, each with its own deque of tasks. A worker pushes and pops at the
+// back of its own deque (LIFO keeps the data it just split warm in cache) and, when it
+// runs dry, steals from the front of another worker's deque (FIFO takes the largest
+// outstanding pieces). parallelFor splits a range recursively so idle workers can
+// steal half of whatever is left.
+
+// Statistics for one parallel job.
+struct JobStats {
+    string name;
+    size_t threads = 0;       // Threads that could take part (workers plus the caller)
+    size_t items = 0;         // Elements in the range
+    size_t tasks = 0;         // Chunks executed
+    size_t steals = 0;        // Chunks executed by a worker that stole them
+    double wallSeconds = 0.0;
+    double busySeconds = 0.0; // Time spent inside chunks, summed over threads
+
+    // Fraction of the available thread time spent doing the job's work.
+    double utilization() const {
+        return wallSeconds > 0.0 && threads > 0 ? busySeconds / (wallSeconds * threads) : 0.0;
+    }
+};
+
+class ThreadPool {
+private:
+    struct Worker {
+        mutex lock;
+        deque<function<void()>> tasks; // DSA: Deque, owner uses the back, thieves the front
+        thread handle;
+    };
+
+    vector<unique_ptr<Worker>> _workers;
+    atomic<size_t> _queued{0};     // Tasks pushed but not yet taken
+    atomic<size_t> _nextQueue{0};  // Round-robin target for tasks from outside the pool
+    mutex _sleepLock;
+    condition_variable _wake;
+    bool _stopping = false;
+
+    // Which pool (if any) the current thread works for, and its index there.
+    static thread_local ThreadPool* tlsPool;
+    static thread_local size_t tlsWorkerIndex;
+    // Whether the task the current thread is running was stolen.
+    static thread_local bool tlsTaskStolen;
+
+    size_t currentWorker() const { return tlsPool == this ? tlsWorkerIndex : _workers.size(); }
+
+    // Takes a task: from the back of our own deque first, then from the front of others'.
+    bool takeTask(size_t self, function<void()>& task, bool& stolen) {
+        if (self < _workers.size()) {
+            Worker& own = *_workers[self];
+            lock_guard<mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                task = move(own.tasks.back());
+                own.tasks.pop_back();
+                stolen = false;
+                return true;
+            }
+        }
+        const size_t count = _workers.size();
+        const size_t start = self < count ? self + 1 : _nextQueue.load(memory_order_relaxed);
+        for (size_t k = 0; k < count; ++k) {
+            Worker& victim = *_workers[(start + k) % count];
+            if (&victim == (self < count ? _workers[self].get() : nullptr)) {
+                continue;
+            }
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+                stolen = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Runs one available task on the calling thread. Returns false if there was none.
+    bool runOne(size_t self) {
+        function<void()> task;
+        bool stolen = false;
+        if (!takeTask(self, task, stolen)) {
+            return false;
+        }
+        _queued.fetch_sub(1, memory_order_relaxed);
+        bool outer = tlsTaskStolen;
+        tlsTaskStolen = stolen;
+        task();
+        tlsTaskStolen = outer;
+        return true;
+    }
+
+    void workerLoop(size_t index) {
+        tlsPool = this;
+        tlsWorkerIndex = index;
+        for (;;) {
+            if (runOne(index)) {
+                continue;
+            }
+            unique_lock<mutex> guard(_sleepLock);
+            _wake.wait(guard, [&] { return _stopping || _queued.load() > 0; });
+            if (_stopping && _queued.load() == 0) {
+                return;
+            }
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threads) {
+        if (threads == 0) {
+            throw invalid_argument("Thread pool needs at least one thread.");
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            _workers.push_back(make_unique<Worker>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            _workers[i]->handle = thread([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> guard(_sleepLock);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto& worker : _workers) {
+            worker->handle.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return _workers.size(); }
+
+    // Queues a task. Tasks submitted from a worker go on that worker's own deque.
+    void submit(function<void()> task) {
+        size_t self = currentWorker();
+        size_t target = self < _workers.size() ? self : _nextQueue.fetch_add(1, memory_order_relaxed) % _workers.size();
+        {
+            lock_guard<mutex> guard(_workers[target]->lock);
+            _workers[target]->tasks.push_back(move(task));
+        }
+        _queued.fetch_add(1);
+        {
+            lock_guard<mutex> guard(_sleepLock); // Pairs with the wait predicate in workerLoop
+        }
+        _wake.notify_one();
+    }
+
+    // Runs queued tasks on the calling thread until done() holds, so a thread waiting on
+    // pool work (including a worker waiting on nested work) keeps the pool moving.
+    template <class Pred>
+    void helpUntil(Pred done) {
+        size_t self = currentWorker();
+        while (!done()) {
+            if (!runOne(self)) {
+                this_thread::yield();
+            }
+        }
+    }
+
+    // Calls fn(begin, end) over [0, count) in chunks of at most `grain` elements, in
+    // parallel, and returns once every chunk has finished. The calling thread helps.
+    template <class Fn>
+    JobStats parallelFor(const string& name, size_t count, size_t grain, Fn fn) {
+        JobStats stats;
+        stats.name = name;
+        stats.items = count;
+        stats.threads = _workers.size() + (currentWorker() < _workers.size() ? 0 : 1);
+        grain = max<size_t>(grain, 1);
+        atomic<size_t> remaining{count};
+        atomic<size_t> tasks{0}, steals{0};
+        atomic<int64_t> busyNanos{0};
+
+        // Splits [begin, end) in halves, leaving the upper halves for thieves, then runs
+        // the last piece here.
+        function<void(size_t, size_t)> runRange = [&](size_t begin, size_t end) {
+            while (end - begin > grain) {
+                size_t middle = begin + (end - begin) / 2;
+                submit([&runRange, middle, end] { runRange(middle, end); });
+                end = middle;
+            }
+            bool stolen = tlsTaskStolen;
+            auto start = chrono::steady_clock::now();
+            fn(begin, end);
+            busyNanos += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+            tasks.fetch_add(1);
+            if (stolen) {
+                steals.fetch_add(1);
+            }
+            remaining.fetch_sub(end - begin); // Last touch of shared state: the job may finish now
+        };
+
+        stats.wallSeconds = timeSeconds([&] {
+            if (count > 0) {
+                bool outer = tlsTaskStolen;
+                tlsTaskStolen = false;
+                runRange(0, count);
+                tlsTaskStolen = outer;
+                helpUntil([&] { return remaining.load() == 0; });
+            }
+        });
+        stats.tasks = tasks.load();
+        stats.steals = steals.load();
+        stats.busySeconds = busyNanos.load() / 1e9;
+        return stats;
+    }
+};
+
+// --- Authorization Holds ---
+// A card authorization places a hold: the amount stops counting toward the available
+// balance but nothing is posted. Later the hold is captured (posted as a withdrawal, in
+// full or in part) or released, and holds nobody settles expire after a few business days.
+
+// One outstanding hold on an account.
+struct Hold {
+    uint64_t id;
+    double amount;
+};
+
+// DSA: Hashed timing wheel for hold expiry. A hold due on day d is filed in slot
+// d mod kSlots, and advancing the clock visits only the slots of the days that passed,
+// so expiry costs O(1) amortized per hold however many are outstanding. Holds due more
+// than kSlots days out stay in their slot through extra turns of the wheel. Captured or
+// released holds are not removed here; the owner skips them when they come due.
+class HoldTimerWheel {
+private:
+    struct Entry {
+        uint64_t holdId;
+        int expiryDay;
+    };
+
+    static constexpr size_t kSlots = 64;
+    array<vector<Entry>, kSlots> _slots;
+    size_t _size = 0;
+
+    static size_t slotOf(int day) { return static_cast<unsigned>(day) % kSlots; }
+
+public:
+    size_t size() const { return _size; }
+
+    void schedule(uint64_t holdId, int expiryDay) {
+        _slots[slotOf(expiryDay)].push_back(Entry{holdId, expiryDay});
+        ++_size;
+    }
+
+    // Calls expire(holdId) for every entry due in (fromDay, toDay].
+    template <class Fn>
+    void advance(int fromDay, int toDay, Fn expire) {
+        const int steps = min<int>(toDay - fromDay, static_cast<int>(kSlots));
+        for (int k = 1; k <= steps; ++k) {
+            vector<Entry>& slot = _slots[slotOf(fromDay + k)];
+            size_t kept = 0;
+            for (const Entry& entry : slot) {
+                if (entry.expiryDay <= toDay) {
+                    expire(entry.holdId);
+                } else {
+                    slot[kept++] = entry; // Due on a later turn of the wheel
+                }
+            }
+            _size -= slot.size() - kept;
+            slot.resize(kept);
+        }
+    }
+};
+
+// --- Pending (ACH) Items ---
+// ACH credits and debits are accepted during the day but only post at a cutoff, when
+// all pending items are applied in one batch (see Bank::runAchCutoff).
+
+// One queued ACH item. Positive amounts are credits, negative amounts debits.
+struct PendingItem {
+    Account* account;
+    double amount;
+};
+
+// --- Negative Lookup Filters ---
+// Much inbound traffic names accounts or customers that do not exist (typos, closed
+// accounts, probing). A Bloom filter over the live IDs answers "definitely absent" for
+// most of those from one cache line, before the ordered maps are walked.
+
+// 64-bit string hash: FNV-1a, finished with a multiply-xorshift so that keys differing
+// only in their last characters (sequential IDs) spread over all bits.
+uint64_t hashString(const string& key);
+
+// DSA: Blocked (split-block) Bloom filter. Each key maps to one 64-byte block and sets
+// one bit in each of the block's eight words, so a lookup costs a single cache miss.
+// At 16 bits per key the false-positive rate is about 0.1-0.2%. Bits cannot be cleared,
+// so the owner rebuilds the filter when enough keys have been removed (see Bank).
+class BlockedBloomFilter {
+private:
+    struct alignas(kCacheLineSize) Block {
+        uint64_t words[8];
+    };
+
+    static constexpr size_t kBitsPerKey = 16;
+
+    vector<Block> _blocks;
+    size_t _capacity = 0; // Keys the filter was sized for
+    size_t _count = 0;    // Keys inserted since the last reset
+
+    // Maps the hash onto [0, blocks) with a multiply instead of a division.
+    size_t blockIndex(uint64_t hash) const {
+        return static_cast<size_t>((static_cast<unsigned __int128>(hash) * _blocks.size()) >> 64);
+    }
+
+    // Bit masks for the eight words: six bits of a remixed hash per word.
+    static void masksFor(uint64_t hash, uint64_t masks[8]) {
+        uint64_t bits = (hash ^ (hash >> 31)) * 0xBF58476D1CE4E5B9ULL;
+        for (int w = 0; w < 8; ++w) {
+            masks[w] = 1ULL << ((bits >> (w * 6 + 16)) & 63);
+        }
+    }
+
+public:
+    BlockedBloomFilter() { reset(1024); }
+
+    // Empties the filter and sizes it for `capacity` keys.
+    void reset(size_t capacity) {
+        _capacity = max<size_t>(capacity, 64);
+        _blocks.assign((_capacity * kBitsPerKey + 511) / 512, Block());
+        _count = 0;
+    }
+
+    size_t size() const { return _count; }
+    size_t capacity() const { return _capacity; }
+    size_t memoryBytes() const { return _blocks.size() * sizeof(Block); }
+
+    void insert(const string& key) {
+        uint64_t hash = hashString(key);
+        uint64_t masks[8];
+        masksFor(hash, masks);
+        Block& block = _blocks[blockIndex(hash)];
+        for (int w = 0; w < 8; ++w) {
+            block.words[w] |= masks[w];
+        }
+        ++_count;
+    }
+
+    // False means the key was certainly never inserted; true means it probably was.
+    bool mayContain(const string& key) const {
+        uint64_t hash = hashString(key);
+        uint64_t masks[8];
+        masksFor(hash, masks);
+        const Block& block = _blocks[blockIndex(hash)];
+        bool present = true;
+        for (int w = 0; w < 8; ++w) {
+            present &= (block.words[w] & masks[w]) != 0; // Branch-free across the block
+        }
+        return present;
+    }
+};
+
+// --- Shared-Memory Balance Replicas ---
+// Front-end processes on the same machine read balances and recent history straight from
+// a table the bank publishes in POSIX shared memory, instead of asking the bank process.
+// Every account has a slot guarded by a seqlock: the (single) writer makes the sequence
+// odd, rewrites the slot and makes it even again, and a reader retries whenever the
+// sequence was odd or changed while it copied. Readers never block the bank and the bank
+// never waits for readers. Only the bank's process maps the table writable.
+
+// One history entry as published (the newest kPublishedHistory entries are kept).
+struct PublishedTransaction {
+    double amount;
+    double newBalance;
+    int64_t date;
+    uint64_t type; // TransactionType
+};
+
+// A consistent copy of one account's published state.
+struct BalanceSnapshot {
+    char accountNumber[24];  // NUL-terminated
+    double balance;          // Posted balance; lazily accrued interest appears once posted
+    double heldAmount;
+    uint64_t version;        // Account::getVersion when published
+    uint64_t historySize;    // Entries in the full history
+    uint32_t currency;       // Currency
+    uint32_t status;         // AccountStatus
+    static constexpr size_t kPublishedHistory = 8;
+    uint64_t recentCount;    // Valid entries in recent, oldest first
+    PublishedTransaction recent[kPublishedHistory];
+};
+
+// One seqlock-guarded slot. The payload is stored as relaxed 64-bit atomic words so that
+// a read racing a write is well-defined (the sequence check discards it). The sequence
+// and the fields every posting changes share the first cache line, and the newest
+// history entries are kept in a ring indexed by history position, one entry per half
+// line, so a posting dirties two cache lines rather than the whole slot.
+struct alignas(kCacheLineSize) BalanceSlot {
+    static constexpr size_t kBalanceWord = 0;
+    static constexpr size_t kHeldWord = 1;
+    static constexpr size_t kVersionWord = 2;
+    static constexpr size_t kHistorySizeWord = 3;
+    static constexpr size_t kStateWord = 4; // Currency in the low half, status in the high half
+    static constexpr size_t kKeyWord = 7;   // Second cache line; written once
+    static constexpr size_t kKeyWords = sizeof(BalanceSnapshot::accountNumber) / 8;
+    static constexpr size_t kRingWord = 11; // Entries start on a 32-byte boundary
+    static constexpr size_t kEntryWords = sizeof(PublishedTransaction) / 8;
+    static constexpr size_t kRing = BalanceSnapshot::kPublishedHistory;
+    static constexpr size_t kWords = kRingWord + kRing * kEntryWords;
+    atomic<uint64_t> sequence{0}; // 0 = never written, odd = being written
+    atomic<uint64_t> words[kWords];
+
+    // Publishes the fields of `snapshot` (its recent entries are ignored) and the history
+    // entries added since the last publish, taken from `history`. The key is only
+    // written by the first publish. Only one thread may write a given slot at a time
+    // (the bank writes it under the account's lock).
+    void publish(const BalanceSnapshot& snapshot, const Transaction* history) {
+        uint64_t sequenceNow = sequence.load(memory_order_relaxed);
+        uint64_t size = snapshot.historySize;
+        uint64_t published = sequenceNow == 0 ? 0 : words[kHistorySizeWord].load(memory_order_relaxed);
+        uint64_t first = max(published <= size ? published : 0, size - min<uint64_t>(size, kRing));
+        sequence.store(sequenceNow + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        storeWord(kBalanceWord, snapshot.balance);
+        storeWord(kHeldWord, snapshot.heldAmount);
+        words[kVersionWord].store(snapshot.version, memory_order_relaxed);
+        words[kHistorySizeWord].store(size, memory_order_relaxed);
+        words[kStateWord].store(snapshot.currency | static_cast<uint64_t>(snapshot.status) << 32, memory_order_relaxed);
+        if (sequenceNow == 0) {
+            uint64_t key[kKeyWords];
+            memcpy(key, snapshot.accountNumber, sizeof(key));
+            for (size_t i = 0; i < kKeyWords; ++i) {
+                words[kKeyWord + i].store(key[i], memory_order_relaxed);
+            }
+        }
+        for (uint64_t i = first; i < size; ++i) {
+            const Transaction& t = history[i];
+            size_t entry = kRingWord + (i % kRing) * kEntryWords;
+            storeWord(entry, t.amount);
+            storeWord(entry + 1, t.newBalance);
+            words[entry + 2].store(static_cast<uint64_t>(t.date), memory_order_relaxed);
+            words[entry + 3].store(static_cast<uint64_t>(t.type), memory_order_relaxed);
+        }
+        sequence.store(sequenceNow + 2, memory_order_release);
+    }
+
+    bool isEmpty() const { return sequence.load(memory_order_acquire) == 0; }
+
+    // True if the slot has been claimed for this account number. The key never changes
+    // once written, so it is compared without the seqlock.
+    bool holds(const string& accountNumber) const {
+        if (isEmpty() || accountNumber.size() >= sizeof(BalanceSnapshot::accountNumber)) {
+            return false;
+        }
+        char key[sizeof(BalanceSnapshot::accountNumber)];
+        loadKey(key);
+        return strncmp(key, accountNumber.c_str(), sizeof(key)) == 0;
+    }
+
+    // Copies the slot without locking. Returns false if it has never been written.
+    // `retries` counts reads discarded because a write overlapped them.
+    bool read(BalanceSnapshot& snapshot, uint64_t* retries = nullptr) const {
+        uint64_t buffer[kWords];
+        for (;;) {
+            uint64_t before = sequence.load(memory_order_acquire);
+            if (before == 0) {
+                return false;
+            }
+            if ((before & 1) == 0) {
+                for (size_t i = 0; i < kWords; ++i) {
+                    buffer[i] = words[i].load(memory_order_relaxed);
+                }
+                atomic_thread_fence(memory_order_acquire);
+                if (sequence.load(memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+            if (retries) {
+                ++*retries;
+            }
+        }
+        memcpy(snapshot.accountNumber, &buffer[kKeyWord], sizeof(snapshot.accountNumber));
+        memcpy(&snapshot.balance, &buffer[kBalanceWord], sizeof(double));
+        memcpy(&snapshot.heldAmount, &buffer[kHeldWord], sizeof(double));
+        snapshot.version = buffer[kVersionWord];
+        snapshot.historySize = buffer[kHistorySizeWord];
+        snapshot.currency = static_cast<uint32_t>(buffer[kStateWord]);
+        snapshot.status = static_cast<uint32_t>(buffer[kStateWord] >> 32);
+        snapshot.recentCount = min<uint64_t>(snapshot.historySize, kRing);
+        for (uint64_t i = 0; i < snapshot.recentCount; ++i) {
+            uint64_t position = snapshot.historySize - snapshot.recentCount + i;
+            memcpy(&snapshot.recent[i], &buffer[kRingWord + (position % kRing) * kEntryWords],
+                   sizeof(PublishedTransaction));
+        }
+        return true;
+    }
+
+private:
+    void storeWord(size_t index, double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        words[index].store(bits, memory_order_relaxed);
+    }
+
+    void loadKey(char* key) const {
+        uint64_t buffer[kKeyWords];
+        for (size_t i = 0; i < kKeyWords; ++i) {
+            buffer[i] = words[kKeyWord + i].load(memory_order_relaxed);
+        }
+        memcpy(key, buffer, sizeof(buffer));
+    }
+};
+static_assert(sizeof(PublishedTransaction) == 32 && (8 + 8 * BalanceSlot::kRingWord) % 32 == 0,
+              "Each published history entry fits in one cache line");
+static_assert(atomic<uint64_t>::is_always_lock_free, "Balance slots are shared between processes");
+
+// The published table: a header and a power-of-two array of slots, open-addressed by
+// account number with linear probing (DSA: Hash table in shared memory). Slots are only
+// ever added, so readers can probe without coordination; an account that is closed stays
+// in its slot with the Closed status.
+class SharedBalanceTable {
+public:
+    struct Header {
+        uint64_t magic;
+        uint64_t slotSize;
+        uint64_t capacity;
+        atomic<uint64_t> used; // Slots claimed so far
+    };
+
+private:
+    string _name;
+    bool _owner;
+    size_t _mappedBytes = 0;
+    void* _mapping = nullptr;
+    Header* _header = nullptr;
+    BalanceSlot* _slots = nullptr;
+
+    // Probes for an account's slot: returns it, or the empty slot where it would go, or
+    // null if the table is full.
+    BalanceSlot* probe(const string& accountNumber, bool& found) const;
+
+public:
+    // Creates (replacing any old one) and maps a table named `name` (e.g. "/bank-balances")
+    // with room for at least `accounts` accounts. The creator is its only writer and
+    // removes the name when destroyed.
+    SharedBalanceTable(const string& name, size_t accounts);
+    // Maps an existing table read-only, from any process.
+    explicit SharedBalanceTable(const string& name);
+    ~SharedBalanceTable();
+    SharedBalanceTable(const SharedBalanceTable&) = delete;
+    SharedBalanceTable& operator=(const SharedBalanceTable&) = delete;
+
+    const string& getName() const { return _name; }
+    size_t capacity() const { return _header->capacity; }
+    size_t size() const { return _header->used.load(memory_order_acquire); }
+
+    // Owner only: returns the account's slot, claiming one if needed (null when full).
+    BalanceSlot* claim(const string& accountNumber);
+
+    // Lock-free lookup from any process. Returns false if the account was never published.
+    bool read(const string& accountNumber, BalanceSnapshot& snapshot, uint64_t* retries = nullptr) const;
+};
+
+// --- Transfer Graph ---
+// Money-flow tracing: every completed transfer is an edge from the source account to the
+// destination. The edge links the transfer's two legs by naming the withdrawal's and the
+// deposit's positions in the accounts' histories, where the amounts live. Vertices are
+// account relation slots (see RelationshipIndex), which are dense.
+// Edges are appended to a log as transfers complete. Traces are breadth-first searches
+// over a CSR index of the log (DSA: rows = source accounts, each sorted by date), so
+// keeping a hop inside a date range is a binary search per row. Each BFS level expands
+// its frontier in parallel, claiming newly reached accounts with a compare-and-swap on a
+// visit stamp. Edges logged after the index was built are scanned directly, and the index
+// is rebuilt once they pass a quarter of it, so new transfers cost amortized O(1) each.
+
+// One transfer. Dates are Unix seconds in 32 unsigned bits (good until 2106).
+struct TransferEdge {
+    uint32_t from;
+    uint32_t to;
+    uint32_t fromLeg; // Position of the withdrawal in the source's history
+    uint32_t toLeg;   // Position of the deposit in the destination's history
+    uint32_t date;
+};
+
+// The accounts a trace reached, in the order it reached them (the start is not included).
+// When several transfers reach an account at the same hop, which one `via` names is unspecified.
+struct FlowTrace {
+    vector<uint32_t> accounts;
+    vector<uint8_t> hops;    // Transfers between the start and accounts[i]
+    vector<uint32_t> via;    // ID of the transfer that first reached accounts[i]
+    size_t edgesScanned = 0; // Edges examined inside the date range
+};
+
+class TransferGraph {
+private:
+    // An entry in the CSR index.
+    struct OutEdge {
+        uint32_t to;
+        uint32_t date;
+        uint32_t id;
+    };
+
+    mutable SpinLock _lock;       // Guards the log while transfers append to it
+    vector<TransferEdge> _edges;  // DSA: Edge log; transfer ID = position + 1
+    size_t _vertexCount = 0;      // One past the largest account slot logged
+    vector<uint32_t> _rowStart;   // CSR row offsets over the first _indexed edges
+    vector<OutEdge> _out;
+    size_t _indexed = 0;
+    // Visit stamps reused across traces: an account was reached by the current trace if
+    // its stamp equals _epoch, so a trace never clears per-account state.
+    unique_ptr<atomic<uint32_t>[]> _stamps;
+    size_t _stampCount = 0;
+    uint32_t _epoch = 0;
+    vector<uint8_t> _depth; // Hop at which each stamped account was reached
+
+    bool claim(uint32_t account) {
+        uint32_t seen = _stamps[account].load(memory_order_relaxed);
+        return seen != _epoch && _stamps[account].compare_exchange_strong(seen, _epoch, memory_order_relaxed);
+    }
+
+public:
+    // Appends a completed transfer and returns its ID (IDs start at 1). Thread-safe.
+    uint32_t record(const TransferEdge& edge) {
+        lock_guard<SpinLock> guard(_lock);
+        _edges.push_back(edge);
+        _vertexCount = max<size_t>(_vertexCount, size_t(max(edge.from, edge.to)) + 1);
+        return static_cast<uint32_t>(_edges.size());
+    }
+
+    void reserve(size_t edges) {
+        lock_guard<SpinLock> guard(_lock);
+        _edges.reserve(edges);
+    }
+
+    size_t edgeCount() const {
+        lock_guard<SpinLock> guard(_lock);
+        return _edges.size();
+    }
+
+    // The transfer with the given ID, or nullptr. Must not race record().
+    const TransferEdge* transfer(uint32_t id) const {
+        return id >= 1 && id <= _edges.size() ? &_edges[id - 1] : nullptr;
+    }
+
+    // Edges covered by the CSR index; the rest are scanned by each trace.
+    size_t indexedCount() const { return _indexed; }
+
+    // Rebuilds the CSR index over the whole log. Rows are sorted in parallel on the pool,
+    // if one is given. Must not race record() or trace().
+    void buildIndex(ThreadPool* pool = nullptr);
+
+    // Breadth-first search from `start` through at most `hops` transfers (up to 255),
+    // following only transfers dated within [fromDate, toDate]. Expands each level on the
+    // pool, if one is given. Must not race record() or another trace.
+    FlowTrace trace(uint32_t start, unsigned hops, time_t fromDate, time_t toDate, ThreadPool* pool = nullptr);
+};
+
+// --- Request Rate Limiting ---
+// Token buckets per account number and per customer ID, so one client flooding an account
+// (directly, in batches or through ACH and card holds) cannot starve the rest. Each bucket
+// is one word: the generic cell rate algorithm (GCRA) keeps the time the bucket will next
+// be full ("due"), so refill is lazy (computed from the clock on each request) and taking
+// a token is a single compare-and-swap. The bank reads a coarse clock, so a bucket may
+// admit up to one tick's worth of requests beyond its burst, e.g. 4 more at 1000
+// requests/s with a 4 ms tick.
+// DSA: Account buckets live in an open-addressing hash table (linear probing, as in
+// AccountIndex) keyed by the hash of the account number. Each names its owner's bucket in
+// a dense array, so charging the customer too costs no second probe. Requests only read
+// the table and update bucket words; entries are added or removed under the bank's
+// exclusive guard.
+
+// A sustained rate in requests per second, and how many requests may arrive at once.
+// A rate of 0 means unlimited.
+struct RateLimit {
+    double rate = 0.0;
+    double burst = 1.0;
+};
+
+class RateLimiter {
+private:
+    static constexpr uint32_t kNoCustomer = UINT32_MAX;
+
+    struct Bucket {
+        uint64_t key = 0;                // Hash of the account number; 0 marks an empty slot
+        uint32_t customer = kNoCustomer; // The owner's bucket in _customerDue
+        atomic<int64_t> due{0};          // Steady nanoseconds at which the bucket is full again
+    };
+
+    unique_ptr<Bucket[]> _accounts;
+    size_t _capacity = 0;
+    size_t _mask = 0;
+    size_t _size = 0;
+    unique_ptr<atomic<int64_t>[]> _customerDue; // DSA: Dense, indexed through _customerIndex
+    size_t _customerCapacity = 0;
+    unordered_map<uint64_t, uint32_t> _customerIndex; // Customer key -> bucket (registration only)
+    vector<uint32_t> _freeCustomers;                  // Buckets of removed customers, for reuse
+    // GCRA parameters per level, in nanoseconds: the time one request is worth, and how far
+    // past now `due` may run (burst requests' worth). An interval of 0 disables the level.
+    int64_t _accountInterval = 0;
+    int64_t _accountTolerance = 0;
+    int64_t _customerInterval = 0;
+    int64_t _customerTolerance = 0;
+    atomic<uint64_t> _rejected{0};
+
+    // Two account numbers whose 64-bit hashes collide would share a bucket, which only
+    // makes them share a limit.
+    static uint64_t keyOf(const string& id) {
+        uint64_t hash = hashString(id);
+        return hash ? hash : 1;
+    }
+
+    Bucket* find(uint64_t key) const {
+        if (_capacity == 0) {
+            return nullptr;
+        }
+        for (size_t pos = key & _mask;; pos = (pos + 1) & _mask) {
+            Bucket& bucket = _accounts[pos];
+            if (bucket.key == key) {
+                return &bucket;
+            }
+            if (bucket.key == 0) {
+                return nullptr;
+            }
+        }
+    }
+
+    // Takes one token: admits the request if it does not push `due` more than `tolerance`
+    // past now.
+    static bool take(atomic<int64_t>& due, int64_t interval, int64_t tolerance, int64_t now) {
+        int64_t current = due.load(memory_order_relaxed);
+        for (;;) {
+            int64_t next = max(current, now) + interval;
+            if (next - now > tolerance) {
+                return false;
+            }
+            if (due.compare_exchange_weak(current, next, memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    void grow();
+
+public:
+    // Sets both levels' limits and empties the table. Rates are in requests per second;
+    // bursts below one are treated as one.
+    void configure(const RateLimit& perAccount, const RateLimit& perCustomer);
+    bool enabled() const { return _accountInterval > 0 || _customerInterval > 0; }
+
+    // Registers a customer, or an account charged to `ownerId` (if registered) as well as
+    // to itself. Each starts with a full bucket.
+    void addCustomer(const string& customerId);
+    void addAccount(const string& accountNumber, const string& ownerId);
+    // Removes an account; later entries of the same cluster shift back into the hole.
+    bool eraseAccount(const string& accountNumber);
+    // Removes a customer. Accounts still charged to them must be erased first.
+    bool eraseCustomer(const string& customerId);
+
+    // Charges one request on `accountNumber` at steady time `now` to the account's bucket
+    // and its owner's. Returns false, charging neither, if either bucket is empty. Account
+    // numbers that are not registered are admitted.
+    bool admit(const string& accountNumber, int64_t now) {
+        Bucket* account = find(keyOf(accountNumber));
+        if (!account) {
+            return true;
+        }
+        if (_accountInterval > 0 && !take(account->due, _accountInterval, _accountTolerance, now)) {
+            _rejected.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        if (_customerInterval > 0 && account->customer != kNoCustomer
+            && !take(_customerDue[account->customer], _customerInterval, _customerTolerance, now)) {
+            if (_accountInterval > 0) {
+                account->due.fetch_sub(_accountInterval, memory_order_relaxed); // Refund the account's token
+            }
+            _rejected.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    size_t accountCount() const { return _size; }
+    size_t customerCount() const { return _customerIndex.size(); }
+    uint64_t getRejectedCount() const { return _rejected.load(memory_order_relaxed); }
+};
+
+// --- Bank Build Profiles ---
+// The bank is a template over four policies, so each deployment compiles in only the
+// features it uses. Empty policies are empty bases and their hooks inline to nothing,
+// so an unused feature costs nothing at runtime.
+//  - Threading: SingleThreaded, or Concurrent (a reader/writer bank lock plus account locks).
+//  - Persistence: InMemory, or Journaled (accepted operations are appended to a journal
+//    that BasicBank::applyJournal replays to rebuild the bank).
+//  - Instrumentation: NoInstrumentation, or OpCounters (calls and latency per operation).
+//  - Logging: ConsoleLog, or SilentLog (no console output; operations use the core paths).
+// `Bank` is the single-threaded, in-memory, uninstrumented console profile.
+
+// Threading: no locking at all. The guards are empty objects (the empty destructor only
+// keeps `auto guard = ...` from being flagged as an unused variable).
+struct SingleThreaded {
+    struct Guard {
+        ~Guard() {}
+    };
+    static Guard sharedGuard() { return Guard(); }
+    static Guard exclusiveGuard() { return Guard(); }
+    template <class... Lockables>
+    static Guard lockAccounts(Lockables&...) { return Guard(); }
+};
+
+// The bank lock held by the current thread, if any (see Concurrent::Guard).
+inline thread_local const void* tlsHeldBankLock = nullptr;
+
+// Threading: public operations hold the bank lock, shared for lookups and single-account
+// money movement (which also lock the accounts involved), exclusive for anything that
+// changes the bank's maps or runs a bulk job. Operations called from inside another
+// operation on the same thread run under the outer operation's lock.
+class Concurrent {
+    mutable shared_mutex _bankLock;
+
+public:
+    class Guard {
+        shared_mutex* _lock = nullptr; // nullptr when an outer operation holds the lock
+        bool _exclusive;
+        const void* _outer;
+
+    public:
+        Guard(shared_mutex& lock, bool exclusive) : _exclusive(exclusive), _outer(tlsHeldBankLock) {
+            if (tlsHeldBankLock == &lock) {
+                return;
+            }
+            _lock = &lock;
+            if (exclusive) {
+                lock.lock();
+            } else {
+                lock.lock_shared();
+            }
+            tlsHeldBankLock = &lock;
+        }
+        ~Guard() {
+            if (!_lock) {
+                return;
+            }
+            if (_exclusive) {
+                _lock->unlock();
+            } else {
+                _lock->unlock_shared();
+            }
+            tlsHeldBankLock = _outer;
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    Guard sharedGuard() const { return Guard(_bankLock, false); }
+    Guard exclusiveGuard() const { return Guard(_bankLock, true); }
+    // Locks one or two accounts (deadlock-free, see scoped_lock) for a money movement.
+    template <class... Lockables>
+    static scoped_lock<Lockables...> lockAccounts(Lockables&... lockables) {
+        return scoped_lock<Lockables...>(lockables...);
+    }
+};
+
+// Persistence: nothing is recorded.
+struct InMemory {
+    template <class... Fields>
+    static void journal(const char*, const Fields&...) {}
+    static void flushJournal() {}
+};
+
+// Persistence: every accepted operation is appended to the attached stream as one
+// tab-separated text record (operation name, then its arguments), in the order the
+// operations took effect. Amounts are written with 17 significant digits so a replay
+// reproduces them exactly. Without a stream attached nothing is written.
+class Journaled {
+    ostream* _journal = nullptr;
+    uint64_t _records = 0;
+    mutex _journalMutex; // Concurrent profiles journal from several threads
+
+public:
+    // Journals to `out` from now on. The stream's number format is set for journaling.
+    void attachJournal(ostream& out) {
+        lock_guard<mutex> lock(_journalMutex);
+        out << defaultfloat << setprecision(17);
+        _journal = &out;
+    }
+    void detachJournal() {
+        lock_guard<mutex> lock(_journalMutex);
+        _journal = nullptr;
+    }
+    uint64_t getJournalRecordCount() const { return _records; }
+
+    // Pushes buffered records to the stream's destination, e.g. so a standby tailing the
+    // journal file sees them.
+    void flushJournal() {
+        lock_guard<mutex> lock(_journalMutex);
+        if (_journal) {
+            _journal->flush();
+        }
+    }
+
+    template <class... Fields>
+    void journal(const char* operation, const Fields&... fields) {
+        if (!_journal) {
+            return;
+        }
+        lock_guard<mutex> lock(_journalMutex);
+        *_journal << operation;
+        ((*_journal << '\t' << fields), ...);
+        *_journal << '\n';
+        ++_records;
+    }
+};
+
+// Operation types measured by OpCounters.
+enum class BankOp : uint8_t { AddCustomer, OpenAccount, Deposit, Withdrawal, Transfer, Lifecycle, Hold, Ach, Batch };
+const size_t kBankOpCount = 9;
+
+// Returns a readable name for a measured operation type.
+const char* bankOpName(BankOp op);
+
+// Instrumentation: nothing is measured.
+struct NoInstrumentation {
+    struct Probe {
+        ~Probe() {}
+    };
+    static Probe probe(BankOp) { return Probe(); }
+};
+
+// Instrumentation: counts the calls to each operation type and their total latency,
+// accepted or not. Counters are relaxed atomics so concurrent profiles can share them.
+class OpCounters {
+    struct Counter {
+        atomic<uint64_t> calls{0};
+        atomic<uint64_t> nanoseconds{0};
+    };
+    array<Counter, kBankOpCount> _counters;
+
+public:
+    // Times one operation; the measurement is recorded when the probe goes out of scope.
+    class Probe {
+        Counter& _counter;
+        chrono::steady_clock::time_point _start;
+
+    public:
+        explicit Probe(Counter& counter) : _counter(counter), _start(chrono::steady_clock::now()) {}
+        ~Probe() {
+            auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - _start);
+            _counter.calls.fetch_add(1, memory_order_relaxed);
+            _counter.nanoseconds.fetch_add(static_cast<uint64_t>(elapsed.count()), memory_order_relaxed);
+        }
+        Probe(const Probe&) = delete;
+        Probe& operator=(const Probe&) = delete;
+    };
+
+    Probe probe(BankOp op) { return Probe(_counters[static_cast<size_t>(op)]); }
+
+    uint64_t getCallCount(BankOp op) const {
+        return _counters[static_cast<size_t>(op)].calls.load(memory_order_relaxed);
+    }
+    // Mean latency of one call, in seconds (0 if never called).
+    double getMeanLatency(BankOp op) const {
+        const Counter& counter = _counters[static_cast<size_t>(op)];
+        uint64_t calls = counter.calls.load(memory_order_relaxed);
+        return calls ? counter.nanoseconds.load(memory_order_relaxed) * 1e-9 / calls : 0.0;
+    }
+
+    // Prints one line per operation type that was called.
+    void printOpStats(ostream& out = cout) const {
+        out << "\n--- Operation Statistics ---" << endl;
+        for (size_t i = 0; i < kBankOpCount; ++i) {
+            BankOp op = static_cast<BankOp>(i);
+            if (getCallCount(op) > 0) {
+                out << left << setw(14) << bankOpName(op) << right << setw(10) << getCallCount(op) << " calls  "
+                    << fixed << setprecision(1) << setw(8) << getMeanLatency(op) * 1e9 << " ns/call"
+                    << setprecision(2) << endl;
+            }
+        }
+        out << "----------------------------\n" << endl;
+    }
+};
+
+// Logging: operation messages go to the console.
+struct ConsoleLog {
+    static constexpr bool kEnabled = true;
+    static ostream& log() { return cout; }
+};
+
+// Swallows everything written to it; the writes compile away.
+struct NullLog {
+    template <class T>
+    const NullLog& operator<<(const T&) const { return *this; }
+    const NullLog& operator<<(ostream& (*)(ostream&)) const { return *this; } // endl
+};
+
+// Logging: no operation messages. The bank calls the non-printing core operations.
+struct SilentLog {
+    static constexpr bool kEnabled = false;
+    static NullLog log() { return NullLog(); }
+};
+
+// --- OOP Classes ---
+
+// Marks an account or customer that is not registered in a RelationshipIndex.
+constexpr uint32_t kNoRelationSlot = numeric_limits<uint32_t>::max();
+
+// Base class for all bank accounts.
+// Demonstrates encapsulation and common attributes.
+class Account {
+protected: // Protected members are accessible by derived classes
+    // Read-mostly fields, packed together at the front of the object.
+    string _accountNumber;
+    string _ownerName; // Title: the name it was opened under. Owners are in the bank's RelationshipIndex
+    int _homeNode;      // NUMA node of the thread that created the account (-1 = unpinned)
+    Currency _currency; // The balance and every amount posted here are in this currency
+    vector<Hold> _holds; // Outstanding authorization holds (only touched by hold operations)
+    size_t _pendingCount = 0; // ACH items queued for the next cutoff
+    uint32_t _relationSlot = kNoRelationSlot; // Row in the bank's owner index (see RelationshipIndex)
+    uint32_t _openerSlot = kNoRelationSlot;   // Relation slot of the customer who opened it
+    // What a posting reads besides the hot fields, plus the anomaly detector's state (written
+    // by postings, and only ever read by them too), share one line. It fits in what used to be
+    // padding, so the account stays the same size and a posting still touches two lines.
+    alignas(kCacheLineSize) AccountStatus _status = AccountStatus::Active;
+    BalanceSlot* _replica = nullptr; // Shared balance table slot this account publishes to, if any
+    AmountStats _depositStats;       // See Streaming Anomaly Detection
+    AmountStats _withdrawalStats;
+    float _anomalySigmasSquared = kDefaultAnomalySigmas * kDefaultAnomalySigmas;
+    uint32_t _anomalyCount = 0;      // Postings flagged so far
+
+    // Fields written on every posting start on their own cache line. The alignment also
+    // pads every Account to whole cache lines, so threads updating neighbouring accounts
+    // never write to the same line (no false sharing), and read-mostly fields above are
+    // not invalidated by balance updates. Subclass fields follow on the same line, which
+    // suits them: they are read on the same postings.
+    alignas(kCacheLineSize) double _balance;
+    uint64_t _version = 0;             // Incremented by every posting
+    SpinLock _lock;                    // Taken by callers that share the account across threads
+    vector<Transaction> _transactions; // DSA: Vector to store transaction history
+    double _heldAmount = 0.0;          // Sum of _holds, checked by every withdrawal
+
+    // Updates a posting stream with an amount and tells whether the amount is anomalous.
+    bool observeAmount(AmountStats& stats, double amount) {
+        bool anomalous = stats.observe(amount, _anomalySigmasSquared);
+        _anomalyCount += anomalous;
+        return anomalous;
+    }
+
+    // Bumps the version after `postings` postings and republishes the account.
+    void recordPosting(uint64_t postings = 1) {
+        _version += postings;
+        publishReplica();
+    }
+
+    // Refreshes the shared balance table slot, if the account is published.
+    void publishReplica() const {
+        if (_replica) {
+            writeReplica();
+        }
+    }
+
+    // Copies the balance, status and new history entries into the slot.
+    void writeReplica() const {
+        BalanceSnapshot snapshot;
+        memset(snapshot.accountNumber, 0, sizeof(snapshot.accountNumber));
+        memcpy(snapshot.accountNumber, _accountNumber.c_str(),
+               min(_accountNumber.size(), sizeof(snapshot.accountNumber) - 1));
+        snapshot.balance = _balance;
+        snapshot.heldAmount = _heldAmount;
+        snapshot.version = _version;
+        snapshot.historySize = _transactions.size();
+        snapshot.currency = static_cast<uint32_t>(_currency);
+        snapshot.status = static_cast<uint32_t>(_status);
+        _replica->publish(snapshot, _transactions.data());
+    }
+
+    // Reports money movement rejected because the account is frozen or closed.
+    void reportInactive(const char* operation) const {
+        cout << operation << " rejected. Account " << _accountNumber
+                  << " is " << accountStatusName(_status) << "." << endl;
+    }
+
+    // Reports why postWithdrawal refused a withdrawal.
+    void reportWithdrawalFailure(OpStatus status, double amount) const {
+        if (status == OpStatus::AccountInactive) {
+            reportInactive("Withdrawal");
+        } else if (status == OpStatus::InvalidAmount) {
+            cout << "Withdrawal amount must be a positive number." << endl;
+        } else {
+            cout << "Insufficient funds. Current balance: $" << fixed << setprecision(2) << _balance
+                      << ". Attempted withdrawal: $" << amount;
+            printHeldSuffix();
+            cout << endl;
+        }
+    }
+
+    // Notes when the posting just made was flagged by the anomaly detector.
+    void reportIfFlagged() const {
+        if (_transactions.back().anomalous) {
+            cout << "Flagged: unusual amount for account " << _accountNumber << "." << endl;
+        }
+    }
+
+    // Appends the held amount to a funds message, when there is one.
+    void printHeldSuffix() const {
+        if (_holds.size() > 0) {
+            cout << ". On hold: $" << fixed << setprecision(2) << _heldAmount;
+        }
+    }
+
+    // Removes a hold from the list and the held total. Returns its amount, or -1 if absent.
+    double removeHold(uint64_t holdId) {
+        for (size_t i = 0; i < _holds.size(); ++i) {
+            if (_holds[i].id == holdId) {
+                double amount = _holds[i].amount;
+                _holds[i] = _holds.back(); // Order of holds does not matter
+                _holds.pop_back();
+                _heldAmount = _holds.empty() ? 0.0 : _heldAmount - amount; // No drift once clear
+                return amount;
+            }
+        }
+        return -1.0;
+    }
+
+public:
+    // Constructor
+    Account(const string& accountNumber, const string& ownerName, double initialBalance = 0.0,
+            Currency currency = Currency::USD)
+        : _accountNumber(accountNumber), _ownerName(ownerName), _homeNode(tlsNumaNode),
+          _currency(currency), _balance(initialBalance) {
+        if (accountNumber.empty()) {
+            throw invalid_argument("Account number cannot be empty.");
+        }
+        if (ownerName.empty()) {
+            throw invalid_argument("Owner name cannot be empty.");
+        }
+        if (initialBalance < 0) {
+            throw invalid_argument("Initial balance cannot be negative.");
+        }
+    }
+
+    // Virtual destructor to ensure proper cleanup of derived classes
+    virtual ~Account() = default;
+
+    // Getter methods
+    const string& getAccountNumber() const { return _accountNumber; }
+    const string& getOwnerName() const { return _ownerName; }
+    // The balance includes interest accrued since it was last posted (see settleInterest).
+    double getBalance() const { return _balance + getAccruedInterest(); }
+    Currency getCurrency() const { return _currency; }
+    int getHomeNode() const { return _homeNode; }
+    uint64_t getVersion() const { return _version; }
+    uint32_t getRelationSlot() const { return _relationSlot; }
+    void setRelationSlot(uint32_t slot) { _relationSlot = slot; }
+    // The customer who opened the account, whoever else joins it later.
+    uint32_t getOpenerSlot() const { return _openerSlot; }
+    void setOpenerSlot(uint32_t slot) { _openerSlot = slot; }
+
+    // Anomaly detection state (see Streaming Anomaly Detection).
+    const AmountStats& getDepositStats() const { return _depositStats; }
+    const AmountStats& getWithdrawalStats() const { return _withdrawalStats; }
+    uint32_t getAnomalyCount() const { return _anomalyCount; }
+    double getAnomalyThreshold() const { return sqrt(_anomalySigmasSquared); }
+
+    // Flags postings more than `sigmas` standard deviations from their stream's mean from
+    // now on. Returns false (and changes nothing) unless sigmas is positive.
+    bool setAnomalyThreshold(double sigmas) {
+        if (!(sigmas > 0)) {
+            return false;
+        }
+        _anomalySigmasSquared = static_cast<float>(sigmas * sigmas);
+        return true;
+    }
+
+    // Accounts are BasicLockable so threads sharing one can use lock_guard/scoped_lock.
+    // Single-threaded code never needs to lock.
+    void lock() { _lock.lock(); }
+    bool try_lock() { return _lock.try_lock(); }
+    void unlock() { _lock.unlock(); }
+    Money getTaggedBalance() const { return Money{getBalance(), _currency}; }
+    AccountStatus getStatus() const { return _status; }
+    bool isActive() const { return _status == AccountStatus::Active; }
+
+    // Interest earned but not yet posted to the balance. Accounts that earn interest
+    // accrue it lazily and only compute it when asked.
+    virtual double getAccruedInterest() const { return 0.0; }
+
+    // Posts any accrued interest to the balance and history. Called before every
+    // mutation and at statement time.
+    virtual void settleInterest() {}
+
+    // Lifecycle cores: change the status without console output. freeze(), unfreeze()
+    // and close() wrap them with the console messages.
+
+    // Freezes an Active account.
+    OpStatus postFreeze() {
+        if (_status != AccountStatus::Active) {
+            return OpStatus::AccountInactive;
+        }
+        _status = AccountStatus::Frozen;
+        publishReplica();
+        return OpStatus::Ok;
+    }
+
+    // Returns a Frozen account to the Active state.
+    OpStatus postUnfreeze() {
+        if (_status != AccountStatus::Frozen) {
+            return OpStatus::AccountInactive;
+        }
+        _status = AccountStatus::Active;
+        publishReplica();
+        return OpStatus::Ok;
+    }
+
+    // Closes an account with a zero balance and nothing held or pending.
+    OpStatus postClose() {
+        if (_status == AccountStatus::Closed) {
+            return OpStatus::AccountInactive;
+        }
+        if (!_holds.empty()) {
+            return OpStatus::HoldsOutstanding;
+        }
+        if (_pendingCount > 0) {
+            return OpStatus::ItemsPending;
+        }
+        settleInterest();
+        if (fabs(_balance) >= 0.005) { // Balances are kept to the cent
+            return OpStatus::BalanceNotZero;
+        }
+        _status = AccountStatus::Closed;
+        _balance = 0.0;
+        recordPosting();
+        _transactions.shrink_to_fit(); // Compact dead state
+        return OpStatus::Ok;
+    }
+
+    // Freezes the account so no deposits or withdrawals are accepted.
+    bool freeze() {
+        if (postFreeze() != OpStatus::Ok) {
+            cout << "Cannot freeze account " << _accountNumber << ": it is "
+                      << accountStatusName(_status) << "." << endl;
+            return false;
+        }
+        cout << "Account " << _accountNumber << " has been frozen." << endl;
+        return true;
+    }
+
+    // Returns a frozen account to the Active state.
+    bool unfreeze() {
+        if (postUnfreeze() != OpStatus::Ok) {
+            cout << "Cannot unfreeze account " << _accountNumber << ": it is "
+                      << accountStatusName(_status) << "." << endl;
+            return false;
+        }
+        cout << "Account " << _accountNumber << " has been unfrozen." << endl;
+        return true;
+    }
+
+    // Closes the account. Only accounts with a zero balance can be closed.
+    // The transaction history is kept for the record but its spare capacity is released.
+    bool close() {
+        switch (postClose()) {
+            case OpStatus::Ok:
+                cout << "Account " << _accountNumber << " has been closed." << endl;
+                return true;
+            case OpStatus::AccountInactive:
+                cout << "Account " << _accountNumber << " is already closed." << endl;
+                return false;
+            case OpStatus::HoldsOutstanding:
+                cout << "Cannot close account " << _accountNumber << ": " << _holds.size()
+                          << " authorization hold(s) outstanding." << endl;
+                return false;
+            case OpStatus::ItemsPending:
+                cout << "Cannot close account " << _accountNumber << ": " << _pendingCount
+                          << " ACH item(s) pending until the next cutoff." << endl;
+                return false;
+            default:
+                cout << "Cannot close account " << _accountNumber << ": balance is $"
+                          << fixed << setprecision(2) << _balance << ". It must be zero." << endl;
+                return false;
+        }
+    }
+
+    // --- Core operations ---
+    // These validate, mutate and record without any console output and report the
+    // outcome as an OpStatus, so they are safe to call from worker threads. deposit()
+    // and withdraw() wrap them with the console messages.
+
+    // Credits the account. Adds a transaction record.
+    OpStatus postDeposit(double amount) {
+        if (_status != AccountStatus::Active) {
+            return OpStatus::AccountInactive;
+        }
+        if (amount <= 0) {
+            return OpStatus::InvalidAmount;
+        }
+        settleInterest();
+        _balance += amount;
+        _transactions.emplace_back(TransactionType::Deposit, amount, _balance,
+                                   observeAmount(_depositStats, amount)); // Add transaction
+        recordPosting();
+        return OpStatus::Ok;
+    }
+
+    // Debits the account if funds allow. Adds a transaction record.
+    // Virtual so subclasses can apply their own funding rules (Polymorphism).
+    virtual OpStatus postWithdrawal(double amount) {
+        if (_status != AccountStatus::Active) {
+            return OpStatus::AccountInactive;
+        }
+        if (amount <= 0) {
+            return OpStatus::InvalidAmount;
+        }
+        settleInterest();
+        if (_balance - _heldAmount < amount) {
+            return OpStatus::InsufficientFunds;
+        }
+        _balance -= amount;
+        _transactions.emplace_back(TransactionType::Withdrawal, amount, _balance,
+                                   observeAmount(_withdrawalStats, amount)); // Add transaction
+        recordPosting();
+        return OpStatus::Ok;
+    }
+
+    // Deposits money into the account.
+    // Adds a transaction record.
+    bool deposit(double amount) {
+        OpStatus status = postDeposit(amount);
+        if (status == OpStatus::AccountInactive) {
+            reportInactive("Deposit");
+            return false;
+        }
+        if (status != OpStatus::Ok) {
+            cout << "Deposit amount must be a positive number." << endl;
+            return false;
+        }
+        cout << "Deposited $" << fixed << setprecision(2) << amount
+                  << " into account " << _accountNumber << ". New balance: $" << _balance << endl;
+        reportIfFlagged();
+        return true;
+    }
+
+    // Withdraws money from the account.
+    // Checks for sufficient funds. Adds a transaction record.
+    // This method is virtual to allow overriding in subclasses for specific rules (Polymorphism).
+    virtual bool withdraw(double amount) {
+        OpStatus status = postWithdrawal(amount);
+        if (status != OpStatus::Ok) {
+            reportWithdrawalFailure(status, amount);
+            return false;
+        }
+        cout << "Withdrew $" << fixed << setprecision(2) << amount
+                  << " from account " << _accountNumber << ". New balance: $" << _balance << endl;
+        reportIfFlagged();
+        return true;
+    }
+
+    // --- Authorization holds ---
+
+    double getHeldAmount() const { return _heldAmount; }
+    size_t getHoldCount() const { return _holds.size(); }
+
+    // How far below zero withdrawals and holds may take the balance (Polymorphism).
+    virtual double getOverdraftAllowance() const { return 0.0; }
+
+    // Funds available to withdrawals and new holds: the balance less holds, plus overdraft.
+    double getAvailableBalance() const { return getBalance() - _heldAmount + getOverdraftAllowance(); }
+
+    // Reserves `amount` under holdId without posting anything.
+    OpStatus placeHold(uint64_t holdId, double amount) {
+        if (_status != AccountStatus::Active) {
+            return OpStatus::AccountInactive;
+        }
+        if (amount <= 0) {
+            return OpStatus::InvalidAmount;
+        }
+        if (getAvailableBalance() < amount) {
+            return getOverdraftAllowance() > 0 ? OpStatus::OverdraftExceeded : OpStatus::InsufficientFunds;
+        }
+        _holds.push_back(Hold{holdId, amount});
+        _heldAmount += amount;
+        recordPosting();
+        return OpStatus::Ok;
+    }
+
+    // Posts up to the held amount as a withdrawal and drops the hold; any remainder of a
+    // partial capture is released. The funds were reserved, so no balance check applies.
+    OpStatus captureHold(uint64_t holdId, double amount) {
+        if (_status != AccountStatus::Active) {
+            return OpStatus::AccountInactive;
+        }
+        double held = -1.0;
+        for (const Hold& hold : _holds) {
+            if (hold.id == holdId) {
+                held = hold.amount;
+            }
+        }
+        if (held < 0) {
+            return OpStatus::HoldNotFound;
+        }
+        if (amount <= 0 || amount > held + 0.005) {
+            return OpStatus::InvalidAmount;
+        }
+        removeHold(holdId);
+        settleInterest();
+        _balance -= amount;
+        _transactions.emplace_back(TransactionType::Withdrawal, amount, _balance,
+                                   observeAmount(_withdrawalStats, amount)); // Add transaction
+        recordPosting();
+        return OpStatus::Ok;
+    }
+
+    // Drops a hold without posting. Returns false if there is no such hold.
+    bool releaseHold(uint64_t holdId) {
+        if (removeHold(holdId) < 0) {
+            return false;
+        }
+        recordPosting();
+        return true;
+    }
+
+    // --- Pending (ACH) items ---
+
+    size_t getPendingCount() const { return _pendingCount; }
+    void notePending() { ++_pendingCount; }
+
+    // Posts this account's run of pending items in one pass, in queue order: interest is
+    // settled, the funds limit read and history space reserved once, then each item is
+    // appended. Credits always post; a debit the available funds cannot cover (or any item
+    // on an account that is no longer active) is returned and marked in `returned`.
+    // Returns the number of items posted.
+    size_t postPendingItems(const PendingItem* items, size_t count, uint8_t* returned) {
+        _pendingCount -= min(_pendingCount, count);
+        if (_status != AccountStatus::Active) {
+            fill(returned, returned + count, 1);
+            return 0;
+        }
+        settleInterest();
+        const double floor = _heldAmount - getOverdraftAllowance(); // Debits may not go below this
+        size_t needed = _transactions.size() + count;
+        if (_transactions.capacity() < needed) {
+            _transactions.reserve(max(needed, 2 * _transactions.capacity())); // Keep growth geometric
+        }
+        double balance = _balance;
+        size_t posted = 0;
+        for (size_t i = 0; i < count; ++i) {
+            double amount = items[i].amount;
+            if (amount < 0 && balance + amount < floor) {
+                returned[i] = 1;
+                continue;
+            }
+            balance += amount;
+            bool debit = amount < 0;
+            _transactions.emplace_back(debit ? TransactionType::Withdrawal : TransactionType::Deposit, fabs(amount),
+                                       balance, observeAmount(debit ? _withdrawalStats : _depositStats, fabs(amount)));
+            ++posted;
+        }
+        _balance = balance;
+        recordPosting(posted);
+        return posted;
+    }
+
+    // Publishes the account to a shared balance table slot from now on (null stops).
+    // Callers sharing the account must hold its lock.
+    void attachReplica(BalanceSlot* slot) {
+        _replica = slot;
+        publishReplica();
+    }
+
+    // Pre-sizes the transaction history so the next `entries` postings never reallocate.
+    void reserveHistory(size_t entries) {
+        _transactions.reserve(_transactions.size() + entries);
+    }
+
+    // Moves the history and hold lists into fresh buffers allocated by the calling thread,
+    // so a shard worker first-touches them on its NUMA node, and makes that node the
+    // account's home. The object keeps its address, so every index pointing at it stays
+    // valid. Callers sharing the account must hold its lock.
+    void relocateStorage() {
+        vector<Transaction> history;
+        history.reserve(_transactions.capacity());
+        history.insert(history.end(), _transactions.begin(), _transactions.end());
+        _transactions.swap(history);
+        vector<Hold> holds(_holds.begin(), _holds.end());
+        _holds.swap(holds);
+        _homeNode = tlsNumaNode;
+    }
+
+    // Returns the list of transactions for this account.
+    const vector<Transaction>& getTransactionHistory() const {
+        return _transactions;
+    }
+
+    // Verifies the history is self-consistent: each entry's new balance follows from the
+    // previous one and its amount, and the last entry matches the current balance.
+    bool isHistoryConsistent() const {
+        if (_transactions.empty()) {
+            return true;
+        }
+        double running = _transactions.front().newBalance;
+        for (size_t i = 1; i < _transactions.size(); ++i) {
+            const Transaction& t = _transactions[i];
+            double expected = t.type == TransactionType::Withdrawal ? running - t.amount : running + t.amount;
+            if (fabs(expected - t.newBalance) >= 0.005) {
+                return false;
+            }
+            running = t.newBalance;
+        }
+        return fabs(running - _balance) < 0.005;
+    }
+
+    // Virtual method to print account details (Polymorphism)
+    // Prints to cout unless another stream is given (statements are built off-thread).
+    virtual void printDetails(ostream& out = cout) const {
+        out << "Account Number: " << _accountNumber
+                  << ", Owner: " << _ownerName
+                  << ", Balance: $" << fixed << setprecision(2) << getBalance();
+        printStatusSuffix(out);
+    }
+
+    // Short type name used in exports ("savings", "checking").
+    virtual const char* getTypeName() const { return "account"; }
+
+protected:
+    // Appends the lifecycle status to printed details for non-active accounts.
+    void printStatusSuffix(ostream& out) const {
+        if (_currency != Currency::USD) {
+            out << ", Currency: " << currencyCode(_currency);
+        }
+        if (_status != AccountStatus::Active) {
+            out << ", Status: " << accountStatusName(_status);
+        }
+        if (!_holds.empty()) {
+            out << ", On Hold: $" << fixed << setprecision(2) << _heldAmount;
+        }
+        if (_pendingCount > 0) {
+            out << ", Pending ACH Items: " << _pendingCount;
+        }
+    }
+};
+
+// Represents a savings account with an interest rate.
+// Inherits from Account.
+class SavingsAccount : public Account {
+private:
+    double _interestRate;
+    // Lazy accrual: interest is earned daily (compounded, Actual/365F) against the
+    // bank's business-day clock but only computed when the account is read, mutated
+    // or put on a statement, so dormant accounts cost nothing between visits.
+    const int* _businessDay = nullptr; // Owning bank's clock; null disables lazy accrual
+    int _lastAccrualDay = 0;           // Interest has been posted up to (not including) this day
+    int _finalDay = 0;                 // The clock's last reading, once detached from the bank
+
+public:
+    // Constructor
+    SavingsAccount(const string& accountNumber, const string& ownerName,
+                   double initialBalance = 0.0, double interestRate = 0.01,
+                   Currency currency = Currency::USD)
+        : Account(accountNumber, ownerName, initialBalance, currency), _interestRate(interestRate) {
+        if (interestRate < 0 || interestRate > 1) {
+            throw invalid_argument("Interest rate must be between 0 and 1 (e.g., 0.01 for 1%).");
+        }
+    }
+
+    double getInterestRate() const { return _interestRate; }
+    int getLastAccrualDay() const { return _lastAccrualDay; }
+
+    // Starts lazy accrual against a business-day clock owned by the bank.
+    void attachClock(const int* businessDay) {
+        _businessDay = businessDay;
+        _lastAccrualDay = *businessDay;
+    }
+
+    // Stops following the bank's clock (e.g. when the bank is destroyed). Interest keeps
+    // accruing lazily up to the clock's last reading, so the balance reads the same.
+    void detachClock() {
+        if (_businessDay) {
+            _finalDay = *_businessDay;
+            _businessDay = &_finalDay;
+        }
+    }
+
+    // Interest earned from the last accrual day up to the current business day.
+    double getAccruedInterest() const override {
+        if (!_businessDay || *_businessDay <= _lastAccrualDay || _status == AccountStatus::Closed) {
+            return 0.0;
+        }
+        DailyCompoundPolicy<Actual365Fixed> policy;
+        policy.prepare(AccrualPeriod{_lastAccrualDay, *_businessDay});
+        return policy.interest(_balance, _interestRate);
+    }
+
+    // Posts interest accrued since the last accrual day.
+    void settleInterest() override {
+        double accrued = getAccruedInterest();
+        if (_businessDay) {
+            markAccruedThrough(*_businessDay);
+        }
+        if (accrued != 0.0) {
+            creditInterest(accrued);
+        }
+    }
+
+    // Records that interest up to `day` has been paid, e.g. by an explicit accrual pass,
+    // so lazy accrual does not pay those days again.
+    void markAccruedThrough(int day) {
+        _lastAccrualDay = max(_lastAccrualDay, day);
+    }
+
+    // Applies interest to the account balance.
+    void applyInterest() {
+        settleInterest();
+        postInterest(_balance * _interestRate);
+    }
+
+    // Applies interest for a period using a compile-time interest policy.
+    template <class Policy>
+    void applyInterest(Policy policy, const AccrualPeriod& period) {
+        settleInterest();
+        policy.prepare(period);
+        postInterest(policy.interest(_balance, _interestRate));
+        markAccruedThrough(period.endDay);
+    }
+
+    // Core operation: credits interest without console output. Returns false for closed
+    // accounts; frozen accounts still earn interest.
+    bool creditInterest(double interestAmount) {
+        if (_status == AccountStatus::Closed) {
+            return false;
+        }
+        _balance += interestAmount;
+        _transactions.emplace_back(TransactionType::InterestApplied, interestAmount, _balance); // Add transaction
+        recordPosting();
+        return true;
+    }
+
+    // Posts an interest amount computed elsewhere (e.g. by a bulk accrual pass).
+    void postInterest(double interestAmount) {
+        if (!creditInterest(interestAmount)) {
+            return;
+        }
+        cout << "Interest of $" << fixed << setprecision(2) << interestAmount
+                  << " applied to savings account " << _accountNumber << ". "
+                  << "New balance: $" << _balance << endl;
+    }
+
+    // Overrides the printDetails method for SavingsAccount specific information.
+    void printDetails(ostream& out = cout) const override {
+        out << "Savings Account Number: " << _accountNumber
+                  << ", Owner: " << _ownerName
+                  << ", Balance: $" << fixed << setprecision(2) << getBalance()
+                  << ", Interest Rate: " << _interestRate * 100 << "%";
+        printStatusSuffix(out);
+    }
+
+    const char* getTypeName() const override { return "savings"; }
+};
+
+// Represents a checking account with an optional overdraft limit.
+// Inherits from Account.
+class CheckingAccount : public Account {
+private:
+    double _overdraftLimit;
+
+public:
+    // Constructor
+    CheckingAccount(const string& accountNumber, const string& ownerName,
+                    double initialBalance = 0.0, double overdraftLimit = 0.0,
+                    Currency currency = Currency::USD)
+        : Account(accountNumber, ownerName, initialBalance, currency), _overdraftLimit(overdraftLimit) {
+        if (overdraftLimit < 0) {
+            throw invalid_argument("Overdraft limit cannot be negative.");
+        }
+    }
+
+    // Withdrawals and holds may use the overdraft limit (Polymorphism).
+    double getOverdraftAllowance() const override { return _overdraftLimit; }
+
+    // Overrides the withdrawal rule to allow overdraft up to the limit (Polymorphism).
+    OpStatus postWithdrawal(double amount) override {
+        if (_status != AccountStatus::Active) {
+            return OpStatus::AccountInactive;
+        }
+        if (amount <= 0) {
+            return OpStatus::InvalidAmount;
+        }
+        if (_balance + _overdraftLimit - _heldAmount < amount) {
+            return OpStatus::OverdraftExceeded;
+        }
+        _balance -= amount;
+        _transactions.emplace_back(TransactionType::Withdrawal, amount, _balance,
+                                   observeAmount(_withdrawalStats, amount)); // Add transaction
+        recordPosting();
+        return OpStatus::Ok;
+    }
+
+    // Overrides the withdraw method to report overdraft denials (Polymorphism).
+    bool withdraw(double amount) override {
+        OpStatus status = postWithdrawal(amount);
+        if (status == OpStatus::OverdraftExceeded) {
+            cout << "Withdrawal denied. Exceeds overdraft limit of $" << fixed << setprecision(2) << _overdraftLimit
+                      << ". Current balance: $" << _balance << ". Attempted withdrawal: $" << amount;
+            printHeldSuffix();
+            cout << endl;
+            return false;
+        }
+        if (status != OpStatus::Ok) {
+            reportWithdrawalFailure(status, amount);
+            return false;
+        }
+        cout << "Withdrew $" << fixed << setprecision(2) << amount
+                  << " from checking account " << _accountNumber << ". New balance: $" << _balance << endl;
+        reportIfFlagged();
+        return true;
+    }
+
+    // Overrides the printDetails method for CheckingAccount specific information.
+    void printDetails(ostream& out = cout) const override {
+        out << "Checking Account Number: " << _accountNumber
+                  << ", Owner: " << _ownerName
+                  << ", Balance: $" << fixed << setprecision(2) << _balance
+                  << ", Overdraft Limit: $" << _overdraftLimit;
+        printStatusSuffix(out);
+    }
+
+    const char* getTypeName() const override { return "checking"; }
+};
+
+// DSA: Open-addressing hash index from account number to account, used for batched
+// lookups. Slots hold only the full 64-bit hash and a pointer (16 bytes, four per cache
+// line), so a probe touches one line and the account itself only to confirm the key.
+// Linear probing; erase uses backward-shift deletion, so there are no tombstones.
+class AccountIndex {
+private:
+    struct Slot {
+        uint64_t hash = 0;
+        Account* account = nullptr; // nullptr marks an empty slot
+    };
+
+    vector<Slot> _slots;
+    size_t _mask = 0;
+    size_t _size = 0;
+
+    // Keys resolved together per group: enough independent misses in flight to hide
+    // memory latency without the group's state spilling out of L1.
+    static constexpr size_t kGroupSize = 16;
+
+    static uint64_t hashKey(const string& key) { return hashString(key); }
+
+    // Continues a probe sequence at `pos` until the key is found or an empty slot is hit.
+    Account* probeFrom(size_t pos, uint64_t hash, const string& key) const {
+        for (;; pos = (pos + 1) & _mask) {
+            const Slot& slot = _slots[pos];
+            if (!slot.account) {
+                return nullptr;
+            }
+            if (slot.hash == hash && slot.account->getAccountNumber() == key) {
+                return slot.account;
+            }
+        }
+    }
+
+    void grow() {
+        vector<Slot> old = move(_slots);
+        _slots.assign(old.empty() ? 64 : old.size() * 2, Slot());
+        _mask = _slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.account) {
+                size_t pos = slot.hash & _mask;
+                while (_slots[pos].account) {
+                    pos = (pos + 1) & _mask;
+                }
+                _slots[pos] = slot;
+            }
+        }
+    }
+
+public:
+    size_t size() const { return _size; }
+
+    // Pre-sizes the table for `count` accounts at a load factor of at most one half.
+    void reserve(size_t count) {
+        while (_slots.size() < count * 2) {
+            grow();
+        }
+    }
+
+    // Adds an account under its account number (which must not already be present).
+    void insert(Account* account) {
+        if ((_size + 1) * 2 > _slots.size()) {
+            grow();
+        }
+        uint64_t hash = hashKey(account->getAccountNumber());
+        size_t pos = hash & _mask;
+        while (_slots[pos].account) {
+            pos = (pos + 1) & _mask;
+        }
+        _slots[pos] = Slot{hash, account};
+        ++_size;
+    }
+
+    // Removes an account number. Later entries of the same cluster shift back into the hole.
+    bool erase(const string& key) {
+        if (_slots.empty()) {
+            return false;
+        }
+        uint64_t hash = hashKey(key);
+        size_t pos = hash & _mask;
+        while (_slots[pos].account
+               && !(_slots[pos].hash == hash && _slots[pos].account->getAccountNumber() == key)) {
+            pos = (pos + 1) & _mask;
+        }
+        if (!_slots[pos].account) {
+            return false;
+        }
+        for (size_t next = (pos + 1) & _mask; _slots[next].account; next = (next + 1) & _mask) {
+            size_t home = _slots[next].hash & _mask;
+            // Move the entry back if its home does not lie cyclically in (pos, next].
+            if (((next - home) & _mask) >= ((next - pos) & _mask)) {
+                _slots[pos] = _slots[next];
+                pos = next;
+            }
+        }
+        _slots[pos] = Slot();
+        --_size;
+        return true;
+    }
+
+    // Looks up one account number. Returns nullptr if it is not present.
+    Account* find(const string& key) const {
+        if (_slots.empty()) {
+            return nullptr;
+        }
+        uint64_t hash = hashKey(key);
+        return probeFrom(hash & _mask, hash, key);
+    }
+
+    // Resolves `count` keys, writing each result (or nullptr) to out[i]. keyAt(i) returns
+    // the i-th key. Keys are processed in groups using group prefetching: first every key
+    // in the group is hashed and its home slot prefetched, then every slot is probed and the
+    // candidate account's number prefetched, and only then are the keys confirmed. The
+    // cache misses of one group overlap instead of forming one dependent chain per key.
+    template <class KeyAt>
+    void findBatch(size_t count, KeyAt keyAt, Account** out) const {
+        if (_slots.empty()) {
+            fill(out, out + count, nullptr);
+            return;
+        }
+        uint64_t hashes[kGroupSize];
+        size_t positions[kGroupSize];
+        for (size_t group = 0; group < count; group += kGroupSize) {
+            const size_t n = min(kGroupSize, count - group);
+            // Stage 1: hash and prefetch the home slots.
+            for (size_t j = 0; j < n; ++j) {
+                hashes[j] = hashKey(keyAt(group + j));
+                positions[j] = hashes[j] & _mask;
+                __builtin_prefetch(&_slots[positions[j]]);
+            }
+            // Stage 2: find the first slot whose hash matches (or the empty slot ending the
+            // probe) and prefetch the candidate's account number for the comparison.
+            for (size_t j = 0; j < n; ++j) {
+                size_t pos = positions[j];
+                while (_slots[pos].account && _slots[pos].hash != hashes[j]) {
+                    pos = (pos + 1) & _mask;
+                }
+                positions[j] = pos;
+                if (Account* candidate = _slots[pos].account) {
+                    __builtin_prefetch(&candidate->getAccountNumber());
+                }
+            }
+            // Stage 3: confirm the keys; a full 64-bit hash collision falls back to probing.
+            for (size_t j = 0; j < n; ++j) {
+                const Slot& slot = _slots[positions[j]];
+                const string& key = keyAt(group + j);
+                if (!slot.account || slot.account->getAccountNumber() == key) {
+                    out[group + j] = slot.account;
+                } else {
+                    out[group + j] = probeFrom((positions[j] + 1) & _mask, hashes[j], key);
+                }
+            }
+        }
+    }
+};
+
+// --- Customer-Account Relationships ---
+// Who owns which account is kept in one index for the whole bank instead of a map per
+// customer. Customers and accounts are numbered densely (their relation slot) when they
+// are registered, and ownership is stored twice as compressed sparse row (CSR)
+// adjacency: customer slot -> the accounts they own, and account slot -> the customer
+// slots of its owners. Listing a customer's accounts or an account's owners reads one
+// contiguous run of an array. An account may have several owners (joint accounts).
+
+// A contiguous run of values from a CSR row. Valid until the structure is next modified.
+template <class T>
+struct CsrRange {
+    const T* first = nullptr;
+    const T* last = nullptr;
+
+    const T* begin() const { return first; }
+    const T* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+// DSA: CSR adjacency with slack. Each row owns a contiguous block of the edge array with
+// some spare capacity, so appending to a row is O(1) until its block is full. A full row
+// moves to the end of the array with twice the capacity, leaving a hole; once holes make
+// up half the array it is compacted. Rows keep their values in insertion order.
+template <class T>
+class SlackCsr {
+private:
+    struct Row {
+        uint32_t begin = 0;
+        uint32_t size = 0;
+        uint32_t capacity = 0;
+    };
+
+    vector<Row> _rows;  // DSA: index = row id
+    vector<T> _edges;
+    size_t _holes = 0;  // Edge slots no row uses
+
+    // Rewrites the edge array with every row packed tightly, in row order.
+    void compact() {
+        vector<T> packed;
+        packed.reserve(_edges.size() - _holes);
+        for (Row& row : _rows) {
+            uint32_t begin = static_cast<uint32_t>(packed.size());
+            packed.insert(packed.end(), _edges.begin() + row.begin, _edges.begin() + row.begin + row.size);
+            row.begin = begin;
+            row.capacity = row.size;
+        }
+        _edges.swap(packed);
+        _holes = 0;
+    }
+
+public:
+    // Adds an empty row and returns its id.
+    uint32_t addRow() {
+        _rows.push_back(Row());
+        return static_cast<uint32_t>(_rows.size() - 1);
+    }
+
+    size_t rowCount() const { return _rows.size(); }
+    size_t edgeCount() const { return _edges.size() - _holes; }
+
+    CsrRange<T> row(uint32_t id) const {
+        const Row& r = _rows[id];
+        return CsrRange<T>{_edges.data() + r.begin, _edges.data() + r.begin + r.size};
+    }
+
+    bool contains(uint32_t id, const T& value) const {
+        CsrRange<T> values = row(id);
+        return find(values.begin(), values.end(), value) != values.end();
+    }
+
+    // Appends a value to a row (amortized O(1)).
+    void append(uint32_t id, const T& value) {
+        Row& r = _rows[id];
+        if (r.size == r.capacity) {
+            uint32_t capacity = max<uint32_t>(2, r.capacity * 2);
+            uint32_t begin = static_cast<uint32_t>(_edges.size());
+            _edges.resize(_edges.size() + capacity);
+            copy(_edges.begin() + r.begin, _edges.begin() + r.begin + r.size, _edges.begin() + begin);
+            _holes += capacity - r.size + r.capacity; // The old block plus the new spare capacity
+            r.begin = begin;
+            r.capacity = capacity;
+        }
+        _edges[r.begin + r.size] = value;
+        ++r.size;
+        --_holes;
+        if (_holes > _edges.size() / 2 && _edges.size() > 1024) {
+            compact();
+        }
+    }
+
+    // Removes a value from a row, keeping the others in order. Returns false if absent.
+    bool remove(uint32_t id, const T& value) {
+        Row& r = _rows[id];
+        auto first = _edges.begin() + r.begin;
+        auto last = first + r.size;
+        auto it = find(first, last, value);
+        if (it == last) {
+            return false;
+        }
+        copy(it + 1, last, it);
+        --r.size;
+        ++_holes;
+        return true;
+    }
+};
+
+// The bank's ownership index: customer -> accounts and account -> owners.
+class RelationshipIndex {
+private:
+    SlackCsr<Account*> _accountsByCustomer; // Row = customer slot
+    SlackCsr<uint32_t> _ownersByAccount;    // Row = account slot; values are customer slots
+    vector<Customer*> _customers;           // DSA: index = customer slot
+    vector<Account*> _accounts;             // DSA: index = account slot
+
+public:
+    // Registers a customer and returns its slot.
+    uint32_t addCustomer(Customer* customer) {
+        _customers.push_back(customer);
+        return _accountsByCustomer.addRow();
+    }
+
+    // Registers an account (with no owners yet) and records its slot on the account.
+    void addAccount(Account& account) {
+        account.setRelationSlot(_ownersByAccount.addRow());
+        _accounts.push_back(&account);
+    }
+
+    // Makes a customer an owner of an account. Returns false if they already are.
+    bool link(uint32_t customerSlot, Account& account) {
+        if (_ownersByAccount.contains(account.getRelationSlot(), customerSlot)) {
+            return false;
+        }
+        _accountsByCustomer.append(customerSlot, &account);
+        _ownersByAccount.append(account.getRelationSlot(), customerSlot);
+        return true;
+    }
+
+    // Removes the account from every owner (e.g. when it is closed).
+    void unlinkAll(Account& account) {
+        CsrRange<uint32_t> owners = _ownersByAccount.row(account.getRelationSlot());
+        vector<uint32_t> slots(owners.begin(), owners.end());
+        for (uint32_t customerSlot : slots) {
+            _accountsByCustomer.remove(customerSlot, &account);
+            _ownersByAccount.remove(account.getRelationSlot(), customerSlot);
+        }
+    }
+
+    bool owns(uint32_t customerSlot, const Account& account) const {
+        return account.getRelationSlot() != kNoRelationSlot
+               && _ownersByAccount.contains(account.getRelationSlot(), customerSlot);
+    }
+
+    // The accounts a customer owns, in the order they were linked.
+    CsrRange<Account*> accountsOf(uint32_t customerSlot) const { return _accountsByCustomer.row(customerSlot); }
+
+    // The slots of an account's owners; the first is the customer who opened it.
+    CsrRange<uint32_t> ownersOf(const Account& account) const {
+        return account.getRelationSlot() == kNoRelationSlot ? CsrRange<uint32_t>()
+                                                            : _ownersByAccount.row(account.getRelationSlot());
+    }
+
+    Customer* customerAt(uint32_t customerSlot) const { return _customers[customerSlot]; }
+    Account* accountAt(uint32_t accountSlot) const { return _accounts[accountSlot]; }
+    size_t ownershipCount() const { return _accountsByCustomer.edgeCount(); }
+};
+
+// Represents a bank customer. The accounts they own are kept in the bank's
+// RelationshipIndex, which the customer reads through once registered.
+class Customer {
+private:
+    string _customerId;
+    string _name;
+    string _address;
+    const RelationshipIndex* _relations = nullptr;
+    uint32_t _relationSlot = kNoRelationSlot;
+
+public:
+    // Constructor
+    Customer(const string& customerId, const string& name, const string& address)
+        : _customerId(customerId), _name(name), _address(address) {
+        if (customerId.empty()) {
+            throw invalid_argument("Customer ID cannot be empty.");
+        }
+        if (name.empty()) {
+            throw invalid_argument("Customer name cannot be empty.");
+        }
+        if (address.empty()) {
+            throw invalid_argument("Address cannot be empty.");
+        }
+    }
+
+    // Getter methods
+    const string& getCustomerId() const { return _customerId; }
+    const string& getName() const { return _name; }
+    const string& getAddress() const { return _address; }
+    uint32_t getRelationSlot() const { return _relationSlot; }
+
+    // Registers the customer in an ownership index (done by the bank).
+    void attachRelations(RelationshipIndex& relations) {
+        _relations = &relations;
+        _relationSlot = relations.addCustomer(this);
+    }
+
+    // Drops the link to the index (when the bank is destroyed); the customer then owns nothing.
+    void detachRelations() { _relations = nullptr; }
+
+    // Returns the number of accounts the customer still holds, joint ones included.
+    size_t getAccountCount() const { return getAccounts().size(); }
+
+    // The customer's open accounts, contiguous in the index (DSA: CSR row), in the order
+    // they were opened or joined. The range points into the bank's index: it is invalid
+    // once the bank opens, closes or joins any account (the index may move or compact), so
+    // callers must not keep it across other bank operations. See getAccountNumbers.
+    CsrRange<Account*> getAccounts() const {
+        return _relations ? _relations->accountsOf(_relationSlot) : CsrRange<Account*>();
+    }
+
+    // The numbers of the customer's open accounts, in the same order, as a copy that stays
+    // valid. Look accounts up through the bank (Bank::getAccount).
+    vector<string> getAccountNumbers() const {
+        vector<string> numbers;
+        for (const Account* account : getAccounts()) {
+            numbers.push_back(account->getAccountNumber());
+        }
+        return numbers;
+    }
+
+    // Returns true if the customer owns the account, alone or jointly.
+    bool ownsAccount(const Account& account) const {
+        return _relations && _relations->owns(_relationSlot, account);
+    }
+
+    // Prints customer details.
+    void printDetails() const {
+        cout << "Customer ID: " << _customerId
+                  << ", Name: " << _name
+                  << ", Address: " << _address
+                  << ", Accounts: " << getAccountCount();
+    }
+};
+
+// Describes one transfer in a batch. The amount is in the source account's currency.
+struct TransferRequest {
+    string fromAccountNum;
+    string toAccountNum;
+    double amount;
+};
+
+// An account a funds trace reached (see BasicBank::traceFunds).
+struct FlowHop {
+    string accountNumber;
+    unsigned hops;       // Transfers between the traced account and this one
+    uint32_t transferId; // The transfer that first reached it
+    double amount;       // What that transfer credited, in this account's currency
+};
+
+// Manages all customers and accounts in the banking system.
+// Uses dictionaries (maps) for efficient storage and retrieval.
+// The policies select the build profile (see Bank Build Profiles); they are private
+// empty bases in the default profile, so the bank is no larger for them.
+template <class Threading, class Persistence, class Instrumentation, class Logging>
+class BasicBank : private Threading, private Persistence, private Instrumentation, private Logging {
+public:
+    using TransferRequest = ::TransferRequest; // Shared by every profile
+
+private:
+    using Threading::sharedGuard;
+    using Threading::exclusiveGuard;
+    using Threading::lockAccounts;
+    using Persistence::journal;
+    using Persistence::flushJournal;
+    using Instrumentation::probe;
+    using Logging::log;
+
+    string _name;
+    // DSA: Map to store customers by customer_id. Using shared_ptr for memory management.
+    map<string, shared_ptr<Customer>> _customers;
+    // DSA: Map to store all accounts by account_number. Using shared_ptr for memory management.
+    map<string, shared_ptr<Account>> _accounts;
+    // Hash index over the same live accounts, for batched lookups (see findAccounts).
+    AccountIndex _accountIndex;
+    // Who owns which open account, in both directions (see Customer-Account Relationships).
+    RelationshipIndex _relations;
+    // Every completed transfer, linking its two legs (see Transfer Graph).
+    TransferGraph _transfers;
+    // Closed accounts and removed customers are moved out of the hot maps above into
+    // these archives, so lookups and iteration only ever see live state.
+    map<string, shared_ptr<Account>> _archivedAccounts;
+    map<string, shared_ptr<Customer>> _archivedCustomers;
+    // Exchange rates used for cross-currency transfers and reporting.
+    FxRateTable _fxRates;
+    // Worker pool for bulk jobs (none = run them on the calling thread), and the
+    // statistics of every bulk job run so far.
+    unique_ptr<ThreadPool> _pool;
+    vector<JobStats> _jobStats;
+    // Optional NUMA placement: when attached, each account is created on the worker of the
+    // shard that owns it (not owned by the bank).
+    ShardRuntime* _shards = nullptr;
+    // Optional shared-memory balance table every account publishes to (not owned by the bank).
+    SharedBalanceTable* _balanceTable = nullptr;
+    // Business-day clock that savings accounts accrue interest against. Advancing it is
+    // O(1); each account catches up lazily the next time it is touched.
+    int _businessDay = currentDayNumber();
+    // Standard deviations from the mean at which postings are flagged, for every account
+    // (see Streaming Anomaly Detection).
+    double _anomalySigmas = kDefaultAnomalySigmas;
+    // Token buckets that requests on an account are charged to before anything is looked up
+    // (see Request Rate Limiting and configureRateLimits). Records applied from a journal
+    // are not limited: they were admitted when they were first made.
+    RateLimiter _rateLimiter;
+    bool _replaying = false;
+    // Authorization holds: the account each outstanding hold is on (DSA: Hash map by hold
+    // id), and when each hold expires.
+    unordered_map<uint64_t, Account*> _holdAccounts;
+    HoldTimerWheel _holdExpiry;
+    uint64_t _nextHoldId = 1;
+    // Bloom filters over live account numbers and customer IDs, checked before the maps so
+    // lookups of unknown IDs usually cost one cache line (see Negative Lookup Filters).
+    BlockedBloomFilter _accountFilter;
+    BlockedBloomFilter _customerFilter;
+    bool _lookupFiltersEnabled = true;
+    // Field buffers reused by applyJournalLine.
+    vector<string> _journalFields;
+
+    // Keeps a lookup filter in step with its map after an insert or removal: rebuilt from
+    // the live keys, at twice their number, once it is full or once more than a quarter
+    // of its keys belong to removed entries (Bloom filter bits cannot be cleared).
+    template <class Map>
+    static void refreshFilter(BlockedBloomFilter& filter, const Map& live, bool force = false) {
+        size_t stale = filter.size() - min(filter.size(), live.size());
+        if (!force && filter.size() < filter.capacity() && stale <= live.size() / 4 + 64) {
+            return;
+        }
+        filter.reset(max<size_t>(2 * live.size(), 1024));
+        for (const auto& pair : live) {
+            filter.insert(pair.first);
+        }
+    }
+
+    // Charges a request on an account to the rate limits. Called before the account is
+    // looked up, so a flood of rejected requests costs one table probe each.
+    bool admitRequest(const string& accountNumber) {
+        if (!_rateLimiter.enabled() || _replaying || _rateLimiter.admit(accountNumber, coarseSteadyNanos())) {
+            return true;
+        }
+        log() << "Request on account " << accountNumber << " rejected: rate limit exceeded." << endl;
+        return false;
+    }
+
+    // Charges each batch item to its source account, in submission order, before the batch
+    // is resolved. Items over the limit are rejected (and reported) here.
+    vector<uint8_t> admitBatch(const vector<TransferRequest>& batch) {
+        vector<uint8_t> admitted(batch.size(), 1);
+        if (_rateLimiter.enabled()) {
+            for (size_t i = 0; i < batch.size(); ++i) {
+                admitted[i] = admitRequest(batch[i].fromAccountNum);
+            }
+        }
+        return admitted;
+    }
+
+    // ACH items accepted since the last cutoff, in submission order.
+    vector<PendingItem> _pendingItems;
+
+    // Queues an ACH credit or debit of `amount` for the next cutoff. The amount is checked
+    // before the request is charged to the rate limits, so an invalid item costs no token.
+    bool queuePending(const string& accountNumber, double amount, bool debit) {
+        const char* kind = debit ? "debit" : "credit";
+        if (!(amount > 0)) {
+            log() << "ACH " << kind << " amount must be a positive number." << endl;
+            return false;
+        }
+        if (!admitRequest(accountNumber)) {
+            return false;
+        }
+        Account* account = findAccount(accountNumber);
+        if (!account) {
+            log() << "Error: Account " << accountNumber << " not found." << endl;
+            return false;
+        }
+        if (!account->isActive()) {
+            log() << "ACH " << kind << " rejected. Account " << accountNumber << " is "
+                      << accountStatusName(account->getStatus()) << "." << endl;
+            return false;
+        }
+        if (debit) {
+            amount = -amount;
+        }
+        _pendingItems.push_back(PendingItem{account, amount});
+        account->notePending();
+        journal("ach", accountNumber, amount);
+        return true;
+    }
+
+    // A rejected withdrawal or close may still have posted lazily accrued interest (it is
+    // settled before funds are checked). Journals that, so a replay settles at the same point.
+    void journalSettlement(const Account& account, uint64_t versionBefore) {
+        if (account.getVersion() != versionBefore) {
+            journal("settle", account.getAccountNumber());
+        }
+    }
+
+    // Account operations through the console wrappers, or straight through the
+    // non-printing cores when the profile does not log.
+    static bool applyDeposit(Account& account, double amount) {
+        if constexpr (Logging::kEnabled) {
+            return account.deposit(amount);
+        } else {
+            return account.postDeposit(amount) == OpStatus::Ok;
+        }
+    }
+    static bool applyWithdrawal(Account& account, double amount) {
+        if constexpr (Logging::kEnabled) {
+            return account.withdraw(amount);
+        } else {
+            return account.postWithdrawal(amount) == OpStatus::Ok;
+        }
+    }
+    static bool applyFreeze(Account& account) {
+        if constexpr (Logging::kEnabled) {
+            return account.freeze();
+        } else {
+            return account.postFreeze() == OpStatus::Ok;
+        }
+    }
+    static bool applyUnfreeze(Account& account) {
+        if constexpr (Logging::kEnabled) {
+            return account.unfreeze();
+        } else {
+            return account.postUnfreeze() == OpStatus::Ok;
+        }
+    }
+    static bool applyClose(Account& account) {
+        if constexpr (Logging::kEnabled) {
+            return account.close();
+        } else {
+            return account.postClose() == OpStatus::Ok;
+        }
+    }
+
+    // Moves money between two resolved accounts: debits `amount` from the source and
+    // credits `creditAmount` (already in the destination's currency) to the destination.
+    // The destination is checked first so a frozen or closed destination never strands
+    // money that was already withdrawn.
+    bool completeTransfer(Account& fromAccount, Account& toAccount, double amount, double creditAmount) {
+        const uint64_t versionBefore = fromAccount.getVersion();
+        if constexpr (!Logging::kEnabled) {
+            if (postTransfer(fromAccount, toAccount, amount, creditAmount) != OpStatus::Ok) {
+                journalSettlement(fromAccount, versionBefore);
+                return false;
+            }
+        } else {
+            if (!toAccount.isActive()) {
+                log() << "Transfer rejected. Account " << toAccount.getAccountNumber() << " is "
+                          << accountStatusName(toAccount.getStatus()) << "." << endl;
+                return false;
+            }
+            if (!fromAccount.withdraw(amount)) { // Use the virtual withdraw method
+                journalSettlement(fromAccount, versionBefore);
+                log() << "Transfer failed due to insufficient funds or other withdrawal error." << endl;
+                return false;
+            }
+            toAccount.deposit(creditAmount); // Use the deposit method
+            reportTransfer(fromAccount, toAccount, amount, creditAmount);
+        }
+        // Both legs are the newest entries; the account locks are still held.
+        recordTransfer(fromAccount, toAccount, fromAccount.getTransactionHistory().size() - 1,
+                       toAccount.getTransactionHistory().size() - 1);
+        journal("transfer", fromAccount.getAccountNumber(), toAccount.getAccountNumber(), amount);
+        return true;
+    }
+
+    // Prints the confirmation for a completed transfer.
+    static void reportTransfer(const Account& fromAccount, const Account& toAccount, double amount, double creditAmount) {
+        log() << "Successfully transferred $" << fixed << setprecision(2) << amount
+                  << " from " << fromAccount.getAccountNumber() << " to " << toAccount.getAccountNumber();
+        if (fromAccount.getCurrency() != toAccount.getCurrency()) {
+            log() << " (" << currencyCode(fromAccount.getCurrency()) << " " << amount << " -> "
+                      << currencyCode(toAccount.getCurrency()) << " " << creditAmount << ")";
+        }
+        log() << "." << endl;
+    }
+
+    // A transfer batch with its accounts resolved and conversions computed.
+    struct PreparedBatch {
+        vector<Account*> resolved; // Sources, then destinations
+        vector<double> credits;    // Amount credited to each destination
+        vector<uint8_t> fromCurrency, toCurrency;
+        Account* source(size_t i) const { return resolved[i]; }
+        Account* destination(size_t i) const { return resolved[credits.size() + i]; }
+    };
+
+    // Resolves all sources and destinations in one batched pass over the hash index and
+    // computes every conversion at the same rates snapshot, in one vectorized pass over
+    // contiguous arrays instead of one rate lookup per transfer.
+    PreparedBatch prepareBatch(const vector<TransferRequest>& batch) const {
+        const size_t count = batch.size();
+        shared_ptr<const FxRateSnapshot> rates = _fxRates.snapshot();
+        PreparedBatch prepared;
+        prepared.resolved.resize(2 * count);
+        _accountIndex.findBatch(2 * count, [&](size_t i) -> const string& {
+            return i < count ? batch[i].fromAccountNum : batch[i - count].toAccountNum;
+        }, prepared.resolved.data());
+        vector<double> amounts(count);
+        prepared.credits.resize(count);
+        prepared.fromCurrency.resize(count);
+        prepared.toCurrency.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            Account* source = prepared.source(i);
+            Account* destination = prepared.destination(i);
+            amounts[i] = batch[i].amount;
+            prepared.fromCurrency[i] = static_cast<uint8_t>(source ? source->getCurrency() : rates->base);
+            prepared.toCurrency[i] = static_cast<uint8_t>(destination ? destination->getCurrency() : rates->base);
+        }
+        fxConvertKernel(*rates, amounts.data(), prepared.fromCurrency.data(), prepared.toCurrency.data(),
+                        prepared.credits.data(), count);
+        return prepared;
+    }
+
+    // Checks a batch item before any money moves. Prints why it is rejected, if it is.
+    static bool checkBatchItem(const PreparedBatch& prepared, const TransferRequest& request, size_t i, bool report) {
+        if (!prepared.source(i) || !prepared.destination(i) || request.fromAccountNum == request.toAccountNum
+            || request.amount <= 0) {
+            if (report) {
+                log() << "Batch item " << i << " rejected: invalid accounts or amount." << endl;
+            }
+            return false;
+        }
+        if (prepared.fromCurrency[i] != prepared.toCurrency[i] && prepared.credits[i] <= 0) {
+            if (report) {
+                log() << "Batch item " << i << " rejected: no exchange rate between "
+                          << currencyCode(prepared.source(i)->getCurrency()) << " and "
+                          << currencyCode(prepared.destination(i)->getCurrency()) << "." << endl;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    // History entries reserved when an account is opened.
+    static constexpr size_t kInitialHistoryCapacity = 16;
+
+    // Formats one account statement: details, then the full history.
+    static void writeStatement(ostream& out, const Account& account) {
+        out << "\n--- Statement for " << account.getAccountNumber() << " ---" << endl;
+        account.printDetails(out);
+        out << endl;
+        for (const auto& t : account.getTransactionHistory()) {
+            t.print(out);
+        }
+        out << "--------------------------------\n" << endl;
+    }
+
+    // Runs a bulk job over [0, count) on the worker pool, or inline when there is none,
+    // and records its statistics.
+    template <class Fn>
+    void runJob(const string& name, size_t count, size_t grain, Fn fn) {
+        _jobStats.push_back(executeJob(name, count, grain, fn));
+    }
+
+    // Like runJob, but returns the statistics instead of recording them.
+    template <class Fn>
+    JobStats executeJob(const string& name, size_t count, size_t grain, Fn fn) {
+        if (_pool) {
+            return _pool->parallelFor(name, count, grain, fn);
+        }
+        JobStats stats;
+        stats.name = name;
+        stats.threads = 1;
+        stats.items = count;
+        stats.tasks = count > 0 ? 1 : 0;
+        stats.wallSeconds = timeSeconds([&] {
+            if (count > 0) {
+                fn(0, count);
+            }
+        });
+        stats.busySeconds = stats.wallSeconds;
+        return stats;
+    }
+
+    // Splits a journal line at its tabs into `fields` and applies it. The field strings
+    // are reused between calls, so a follower applying a long stream does not allocate
+    // per record.
+    bool applyJournalLineLocked(const string& line, vector<string>& fields) {
+        size_t count = 0;
+        for (size_t begin = 0;; ++count) {
+            size_t tab = line.find('\t', begin);
+            size_t end = tab == string::npos ? line.size() : tab;
+            if (count == fields.size()) {
+                fields.emplace_back();
+            }
+            fields[count].assign(line, begin, end - begin);
+            if (tab == string::npos) {
+                break;
+            }
+            begin = tab + 1;
+        }
+        fields.resize(count + 1);
+        bool replaying = _replaying;
+        _replaying = true;
+        bool applied = applyJournalRecord(fields);
+        _replaying = replaying;
+        return applied;
+    }
+
+    // Applies one journal record, split into its fields. Returns false if it is malformed
+    // or the bank rejects it.
+    bool applyJournalRecord(const vector<string>& fields) {
+        auto number = [&](size_t i) { return strtod(fields[i].c_str(), nullptr); };
+        const string& op = fields.empty() ? string() : fields[0];
+        const size_t count = fields.size();
+        Currency currency;
+        if (op == "customer" && count == 3) {
+            return addCustomer(fields[1], fields[2]) != nullptr;
+        } else if (op == "account" && count == 7 && parseCurrency(fields[6], currency)) {
+            return createAccount(fields[1], fields[2], number(3), number(4), number(5), currency) != nullptr;
+        } else if (op == "deposit" && count == 3) {
+            return deposit(fields[1], number(2));
+        } else if (op == "withdraw" && count == 3) {
+            return withdraw(fields[1], number(2));
+        } else if (op == "transfer" && count == 4) {
+            return transferFunds(fields[1], fields[2], number(3));
+        } else if (op == "freeze" && count == 2) {
+            return freezeAccount(fields[1]);
+        } else if (op == "unfreeze" && count == 2) {
+            return unfreezeAccount(fields[1]);
+        } else if (op == "close" && count == 3) {
+            return closeAccount(fields[1], fields[2]);
+        } else if (op == "remove" && count == 2) {
+            return removeCustomer(fields[1]);
+        } else if (op == "advance" && count == 2) {
+            advanceBusinessDays(atoi(fields[1].c_str()));
+            return true;
+        } else if (op == "rate" && count == 3 && parseCurrency(fields[1], currency)) {
+            return setExchangeRate(currency, number(2));
+        } else if (op == "anomaly" && count == 2) {
+            return setAnomalyThreshold(number(1));
+        } else if (op == "hold" && count == 4) {
+            return authorizeHold(fields[1], number(2), atoi(fields[3].c_str())) != 0;
+        } else if (op == "capture" && count == 3) {
+            return captureHold(strtoull(fields[1].c_str(), nullptr, 10), number(2));
+        } else if (op == "release" && count == 2) {
+            return releaseHold(strtoull(fields[1].c_str(), nullptr, 10));
+        } else if (op == "ach" && count == 3) {
+            double amount = number(2);
+            return amount < 0 ? queueAchDebit(fields[1], -amount) : queueAchCredit(fields[1], amount);
+        } else if (op == "cutoff" && count == 1) {
+            runAchCutoff();
+            return true;
+        } else if (op == "joint" && count == 3) {
+            return addJointOwner(fields[1], fields[2]);
+        } else if (op == "heartbeat" && count == 2) {
+            journal("heartbeat", fields[1]); // Passed on, so chained standbys can measure lag too
+            return true;
+        } else if (op == "settle" && count == 2) {
+            Account* account = findAccount(fields[1]);
+            if (!account) {
+                return false;
+            }
+            account->settleInterest();
+            journal("settle", fields[1]);
+            return true;
+        } else if (op == "interest" && count == 4) {
+            // One record per savings account of an accrual run, credited or not.
+            auto* savings = dynamic_cast<SavingsAccount*>(findAccount(fields[1]));
+            if (!savings) {
+                return false;
+            }
+            savings->settleInterest();
+            savings->creditInterest(number(2));
+            savings->markAccruedThrough(atoi(fields[3].c_str()));
+            journal("interest", fields[1], number(2), atoi(fields[3].c_str()));
+            return true;
+        }
+        return false;
+    }
+
+    // Simple counter for generating unique IDs (for demonstration)
+    long long _nextCustomerId = 1000;
+    long long _nextAccountNumber = 100000;
+
+public:
+    // Constructor
+    BasicBank(const string& name, Currency baseCurrency = Currency::USD) : _name(name), _fxRates(baseCurrency) {}
+
+    // Accounts and customers are handed out as shared_ptr and may outlive the bank: cut
+    // their links to the bank's business-day clock and ownership index.
+    ~BasicBank() {
+        for (const auto* accounts : {&_accounts, &_archivedAccounts}) {
+            for (const auto& pair : *accounts) {
+                if (auto* savings = dynamic_cast<SavingsAccount*>(pair.second.get())) {
+                    savings->detachClock();
+                }
+            }
+        }
+        for (const auto* customers : {&_customers, &_archivedCustomers}) {
+            for (const auto& pair : *customers) {
+                pair.second->detachRelations();
+            }
+        }
+    }
+
+    // The profile's persistence and instrumentation policies, e.g. to attach a journal
+    // (Journaled) or read operation statistics (OpCounters).
+    Persistence& getPersistence() { return *this; }
+    const Instrumentation& getInstrumentation() const { return *this; }
+
+    // Public getter for the bank's name
+    const string& getName() const { return _name; }
+
+    // Sets the number of worker threads used by bulk jobs (0 = run them inline).
+    void configureWorkers(size_t threads) {
+        auto guard = exclusiveGuard();
+        _pool.reset();
+        if (threads > 0) {
+            _pool = make_unique<ThreadPool>(threads);
+        }
+        log() << "Bulk jobs will use " << threads << " worker thread(s)." << endl;
+    }
+    size_t getWorkerCount() const { return _pool ? _pool->size() : 0; }
+    // The bulk-job pool, or nullptr when jobs run inline.
+    ThreadPool* getWorkerPool() const { return _pool.get(); }
+
+    // Logs a completed transfer, given where its legs sit in the two histories. Callers
+    // that move money with postTransfer record the transfers they completed, in order.
+    uint32_t recordTransfer(const Account& fromAccount, const Account& toAccount, size_t fromLeg, size_t toLeg) {
+        return _transfers.record({fromAccount.getRelationSlot(), toAccount.getRelationSlot(),
+                                  static_cast<uint32_t>(fromLeg), static_cast<uint32_t>(toLeg),
+                                  static_cast<uint32_t>(fromAccount.getTransactionHistory()[fromLeg].date)});
+    }
+
+    // The same money movement as completeTransfer, without console output, for worker threads.
+    static OpStatus postTransfer(Account& fromAccount, Account& toAccount, double amount, double creditAmount) {
+        if (!toAccount.isActive()) {
+            return OpStatus::AccountInactive;
+        }
+        OpStatus status = fromAccount.postWithdrawal(amount);
+        if (status == OpStatus::Ok) {
+            toAccount.postDeposit(creditAmount);
+        }
+        return status;
+    }
+
+    // Statistics of every bulk job run so far, oldest first.
+    const vector<JobStats>& getJobStats() const { return _jobStats; }
+
+    // Prints one line of statistics per bulk job run so far.
+    void printJobStats() const {
+        auto guard = sharedGuard();
+        cout << "\n--- Bulk Job Statistics ---" << endl;
+        for (const JobStats& stats : _jobStats) {
+            cout << left << setw(18) << stats.name << right << setw(9) << stats.items << " items  "
+                      << setw(6) << stats.tasks << " tasks  " << setw(5) << stats.steals << " steals  "
+                      << setw(3) << stats.threads << " threads  " << fixed << setprecision(3)
+                      << setw(8) << stats.wallSeconds * 1e3 << " ms  " << setprecision(1)
+                      << setw(5) << stats.utilization() * 100 << "% busy" << setprecision(2) << endl;
+        }
+        cout << "---------------------------\n" << endl;
+    }
+
+    // Places new accounts on the NUMA node of their owning shard from now on.
+    void attachShards(ShardRuntime* shards) { _shards = shards; }
+    ShardRuntime* getShards() const { return _shards; }
+
+    // Publishes every live account, and every account opened from now on, to a shared
+    // balance table that other processes can read lock-free (see Shared-Memory Balance
+    // Replicas). Each posting then also rewrites the account's slot. Passing null stops
+    // publishing; the table keeps its last contents. Fails if the table is too small.
+    bool publishBalances(SharedBalanceTable* table) {
+        auto guard = exclusiveGuard();
+        if (table && table->capacity() * 2 / 3 < table->size() + _accounts.size()) {
+            log() << "Error: Shared balance table " << table->getName() << " is too small for "
+                  << _accounts.size() << " accounts." << endl;
+            return false;
+        }
+        _balanceTable = table;
+        for (auto& pair : _accounts) {
+            pair.second->attachReplica(table ? table->claim(pair.first) : nullptr);
+        }
+        for (auto& pair : _archivedAccounts) {
+            pair.second->attachReplica(nullptr); // Closed: readers keep the final Closed state
+        }
+        return true;
+    }
+    SharedBalanceTable* getBalanceTable() const { return _balanceTable; }
+
+    // Moves a live account to another shard while traffic continues (see
+    // ShardRuntime::migrate). Requests routed to it meanwhile are queued and replayed on
+    // the new shard. Its history and holds are rebuilt on the target's NUMA node; the
+    // balance, the account maps, the customer's list and the hold index keep pointing
+    // at the same object, so none of them change.
+    bool migrateAccount(const string& accountNumber, size_t targetShard, MigrationStats* stats = nullptr) {
+        if (!_shards) {
+            log() << "Error: No shards are attached." << endl;
+            return false;
+        }
+        shared_ptr<Account> account = getAccount(accountNumber);
+        if (!account) {
+            log() << "Error: Account " << accountNumber << " not found." << endl;
+            return false;
+        }
+        bool moved = _shards->migrate(accountNumber, targetShard, [&] {
+            auto accountLock = lockAccounts(*account);
+            account->relocateStorage();
+        }, stats);
+        if (!moved) {
+            log() << "Error: Account " << accountNumber << " cannot be migrated to shard " << targetShard << "." << endl;
+            return false;
+        }
+        log() << "Account " << accountNumber << " migrated to shard " << targetShard << "." << endl;
+        return true;
+    }
+
+    // Returns the current business day (days since 1970-01-01).
+    int getBusinessDay() const { return _businessDay; }
+
+    // Moves the business day forward. This replaces a nightly pass over every savings
+    // account: interest for the skipped days is materialized per account on next use.
+    void advanceBusinessDays(int days = 1) {
+        auto guard = exclusiveGuard();
+        if (days <= 0) {
+            log() << "Business days to advance must be a positive number." << endl;
+            return;
+        }
+        size_t expired = 0;
+        _holdExpiry.advance(_businessDay, _businessDay + days, [&](uint64_t holdId) {
+            auto it = _holdAccounts.find(holdId);
+            if (it != _holdAccounts.end()) { // Otherwise already captured or released
+                it->second->releaseHold(holdId);
+                _holdAccounts.erase(it);
+                ++expired;
+            }
+        });
+        _businessDay += days;
+        journal("advance", days);
+        int year;
+        unsigned month, day;
+        civilFromDays(_businessDay, year, month, day);
+        log() << "Business day advanced to " << year << "-" << setfill('0') << setw(2) << month
+                  << "-" << setw(2) << day << setfill(' ') << "." << endl;
+        if (expired > 0) {
+            log() << expired << " authorization hold(s) expired and were released." << endl;
+        }
+    }
+
+    // Authorizes a card payment: holds `amount` on the account for up to `validDays`
+    // business days. Returns the hold id, or 0 if the authorization is declined.
+    uint64_t authorizeHold(const string& accountNumber, double amount, int validDays = 7) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::Hold);
+        if (!admitRequest(accountNumber)) {
+            return 0;
+        }
+        Account* account = findAccount(accountNumber);
+        if (!account) {
+            log() << "Error: Account " << accountNumber << " not found." << endl;
+            return 0;
+        }
+        if (validDays <= 0) {
+            log() << "Hold validity must be at least one business day." << endl;
+            return 0;
+        }
+        uint64_t holdId = _nextHoldId;
+        OpStatus status = account->placeHold(holdId, amount);
+        if (status != OpStatus::Ok) {
+            log() << "Authorization of $" << fixed << setprecision(2) << amount << " on account "
+                      << accountNumber << " declined: " << opStatusDescription(status)
+                      << ". Available balance: $" << account->getAvailableBalance() << endl;
+            return 0;
+        }
+        ++_nextHoldId;
+        _holdAccounts.emplace(holdId, account);
+        _holdExpiry.schedule(holdId, _businessDay + validDays);
+        journal("hold", accountNumber, amount, validDays);
+        log() << "Authorized hold " << holdId << " of $" << fixed << setprecision(2) << amount << " on account "
+                  << accountNumber << ". Available balance: $" << account->getAvailableBalance() << endl;
+        return holdId;
+    }
+
+    // Captures `amount` (at most the held amount) of a hold, posting it as a withdrawal.
+    bool captureHold(uint64_t holdId, double amount) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::Hold);
+        auto it = _holdAccounts.find(holdId);
+        if (it == _holdAccounts.end()) {
+            log() << "Error: Hold " << holdId << " not found (captured, released or expired)." << endl;
+            return false;
+        }
+        Account* account = it->second;
+        OpStatus status = account->captureHold(holdId, amount);
+        if (status != OpStatus::Ok) {
+            log() << "Capture of hold " << holdId << " failed: " << opStatusDescription(status) << "." << endl;
+            return false;
+        }
+        _holdAccounts.erase(it);
+        journal("capture", holdId, amount);
+        log() << "Captured $" << fixed << setprecision(2) << amount << " of hold " << holdId << " on account "
+                  << account->getAccountNumber() << ". New balance: $" << account->getBalance() << endl;
+        return true;
+    }
+
+    // Releases a hold without posting anything.
+    bool releaseHold(uint64_t holdId) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::Hold);
+        auto it = _holdAccounts.find(holdId);
+        if (it == _holdAccounts.end()) {
+            log() << "Error: Hold " << holdId << " not found (captured, released or expired)." << endl;
+            return false;
+        }
+        it->second->releaseHold(holdId);
+        journal("release", holdId);
+        log() << "Released hold " << holdId << " on account " << it->second->getAccountNumber() << "." << endl;
+        _holdAccounts.erase(it);
+        return true;
+    }
+
+    size_t getOutstandingHoldCount() const { return _holdAccounts.size(); }
+
+    // Queue ACH items for the next cutoff. Nothing posts until runAchCutoff.
+    bool queueAchCredit(const string& accountNumber, double amount) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::Ach);
+        return queuePending(accountNumber, amount, false);
+    }
+    bool queueAchDebit(const string& accountNumber, double amount) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::Ach);
+        return queuePending(accountNumber, amount, true);
+    }
+    size_t getPendingItemCount() const { return _pendingItems.size(); }
+
+    // Posts every queued ACH item. The items are sorted by account (a stable sort, so each
+    // account's items stay in submission order), then each account's run is posted in one
+    // pass on the worker pool (runs touch disjoint accounts). All postings carry the cutoff
+    // time. Debits that cannot be covered are returned. Returns the number posted.
+    size_t runAchCutoff() {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::Ach);
+        journal("cutoff");
+        vector<PendingItem> items = move(_pendingItems);
+        _pendingItems.clear();
+        // DSA: Stable sort by account groups each account's items contiguously.
+        stable_sort(items.begin(), items.end(), [](const PendingItem& a, const PendingItem& b) {
+            return less<const Account*>()(a.account, b.account);
+        });
+        vector<size_t> runStart;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (i == 0 || items[i].account != items[i - 1].account) {
+                runStart.push_back(i);
+            }
+        }
+        const size_t runs = runStart.size();
+        runStart.push_back(items.size());
+
+        vector<uint8_t> returned(items.size(), 0);
+        const time_t cutoffTime = time(nullptr);
+        runJob("ach cutoff", runs, 64, [&](size_t begin, size_t end) {
+            time_t outer = tlsTransactionTime;
+            tlsTransactionTime = cutoffTime;
+            for (size_t r = begin; r < end; ++r) {
+                size_t first = runStart[r];
+                items[first].account->postPendingItems(&items[first], runStart[r + 1] - first, &returned[first]);
+            }
+            tlsTransactionTime = outer;
+        });
+
+        size_t posted = 0;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (!returned[i]) {
+                ++posted;
+                continue;
+            }
+            log() << "Returned ACH " << (items[i].amount < 0 ? "debit" : "credit") << " of $" << fixed
+                      << setprecision(2) << fabs(items[i].amount) << " on account "
+                      << items[i].account->getAccountNumber() << ": "
+                      << (items[i].account->isActive() ? "insufficient funds" : "account is not active") << "." << endl;
+        }
+        log() << "ACH cutoff: posted " << posted << " of " << items.size() << " item(s) across " << runs
+                  << " account(s)." << endl;
+        return posted;
+    }
+
+    // Flags postings more than `sigmas` standard deviations from their account's running
+    // mean for deposits (or for withdrawals), on every account from now on.
+    bool setAnomalyThreshold(double sigmas) {
+        auto guard = exclusiveGuard();
+        if (!(sigmas > 0)) {
+            log() << "Error: Anomaly threshold must be a positive number of standard deviations." << endl;
+            return false;
+        }
+        _anomalySigmas = sigmas;
+        for (auto& pair : _accounts) {
+            pair.second->setAnomalyThreshold(sigmas);
+        }
+        journal("anomaly", sigmas);
+        log() << "Anomaly threshold set to " << fixed << setprecision(1) << sigmas << " standard deviations."
+              << setprecision(2) << endl;
+        return true;
+    }
+    double getAnomalyThreshold() const { return _anomalySigmas; }
+
+    // Limits requests on each account, and in total on each customer's accounts: deposits,
+    // withdrawals, transfers and batch transfer items (charged to the source account), ACH
+    // items when queued, and card authorizations. Captures and releases of an authorized
+    // hold, and ACH cutoffs, are not charged. A customer is charged for the accounts they
+    // opened; joint owners are not. A rate of 0 lifts that limit. Every bucket starts full.
+    // Limits are not journaled.
+    bool configureRateLimits(const RateLimit& perAccount, const RateLimit& perCustomer) {
+        auto guard = exclusiveGuard();
+        if (!(perAccount.rate >= 0) || !(perCustomer.rate >= 0)) {
+            log() << "Error: Rate limits must be non-negative." << endl;
+            return false;
+        }
+        _rateLimiter.configure(perAccount, perCustomer);
+        if (!_rateLimiter.enabled()) {
+            log() << "Rate limits lifted." << endl;
+            return true;
+        }
+        for (const auto& pair : _customers) {
+            _rateLimiter.addCustomer(pair.first);
+        }
+        for (const auto& pair : _accounts) {
+            uint32_t opener = pair.second->getOpenerSlot();
+            _rateLimiter.addAccount(pair.first, opener == kNoRelationSlot ? string()
+                                                : _relations.customerAt(opener)->getCustomerId());
+        }
+        auto describe = [](const RateLimit& limit) {
+            ostringstream text;
+            if (limit.rate > 0) {
+                text << fixed << setprecision(2) << limit.rate << "/s (burst " << max(1.0, limit.burst) << ")";
+            } else {
+                text << "unlimited";
+            }
+            return text.str();
+        };
+        log() << "Rate limits: " << describe(perAccount) << " per account, " << describe(perCustomer) << " per customer."
+              << endl;
+        return true;
+    }
+    const RateLimiter& getRateLimiter() const { return _rateLimiter; }
+
+    // Exchange-rate table access. Rates are quoted against the bank's base currency.
+    const FxRateTable& getFxRates() const { return _fxRates; }
+    bool setExchangeRate(Currency currency, double valueInBase) {
+        auto guard = exclusiveGuard();
+        if (!_fxRates.setRate(currency, valueInBase)) {
+            return false;
+        }
+        journal("rate", currencyCode(currency), valueInBase);
+        log() << "Exchange rate set: 1 " << currencyCode(currency) << " = " << fixed << setprecision(4)
+                  << valueInBase << " " << currencyCode(_fxRates.getBaseCurrency())
+                  << " (rates version " << _fxRates.getVersion() << ")" << setprecision(2) << endl;
+        return true;
+    }
+
+    // Creates and adds a new customer to the bank.
+    shared_ptr<Customer> addCustomer(const string& name, const string& address) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::AddCustomer);
+        string customerId = "C" + to_string(_nextCustomerId++); // Generate unique ID
+        auto customer = make_shared<Customer>(customerId, name, address);
+        customer->attachRelations(_relations);
+        _customers[customerId] = customer; // DSA: Map insertion O(log N)
+        _customerFilter.insert(customerId);
+        refreshFilter(_customerFilter, _customers);
+        if (_rateLimiter.enabled()) {
+            _rateLimiter.addCustomer(customerId);
+        }
+        journal("customer", name, address);
+        log() << "Customer '" << name << "' added with ID: " << customerId << endl;
+        return customer;
+    }
+
+    // Retrieves a customer by their ID (DSA: Map lookup O(log N)).
+    shared_ptr<Customer> getCustomer(const string& customerId) const {
+        auto guard = sharedGuard();
+        if (_lookupFiltersEnabled && !_customerFilter.mayContain(customerId)) {
+            return nullptr; // Certainly unknown: the map is not touched
+        }
+        auto it = _customers.find(customerId);
+        if (it != _customers.end()) {
+            return it->second;
+        }
+        return nullptr; // Customer not found
+    }
+
+    // Creates a new account (Savings or Checking) for a given customer.
+    shared_ptr<Account> createAccount(const string& customerId, const string& accountType,
+                                           double initialBalance = 0.0,
+                                           double interestRate = 0.01, double overdraftLimit = 0.0,
+                                           Currency currency = Currency::USD) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::OpenAccount);
+        shared_ptr<Customer> customer = getCustomer(customerId);
+        if (!customer) {
+            log() << "Error: Customer with ID " << customerId << " not found." << endl;
+            return nullptr;
+        }
+
+        if (accountType != "savings" && accountType != "checking") {
+            log() << "Invalid account type. Choose 'savings' or 'checking'." << endl;
+            return nullptr;
+        }
+        string accountNumber = "ACC" + to_string(_nextAccountNumber++); // Generate unique account number
+
+        auto construct = [&]() -> shared_ptr<Account> {
+            shared_ptr<Account> created;
+            if (accountType == "savings") {
+                auto savings = make_shared<SavingsAccount>(accountNumber, customer->getName(), initialBalance, interestRate, currency);
+                savings->attachClock(&_businessDay);
+                created = savings;
+            } else {
+                created = make_shared<CheckingAccount>(accountNumber, customer->getName(), initialBalance, overdraftLimit, currency);
+            }
+            created->reserveHistory(kInitialHistoryCapacity); // First-touched by the constructing thread
+            created->setAnomalyThreshold(_anomalySigmas);
+            return created;
+        };
+        // With shards attached, construct on the owning shard's pinned worker so the account
+        // and its history buffer are allocated on that shard's NUMA node.
+        shared_ptr<Account> account = _shards ? _shards->run(_shards->shardFor(accountNumber), construct) : construct();
+
+        _relations.addAccount(*account);
+        _relations.link(customer->getRelationSlot(), *account);
+        account->setOpenerSlot(customer->getRelationSlot());
+        log() << "Account " << accountNumber << " added for customer " << customer->getName() << "." << endl;
+        _accounts[accountNumber] = account; // DSA: Map insertion O(log N)
+        if (_balanceTable) {
+            account->attachReplica(_balanceTable->claim(accountNumber));
+        }
+        _accountIndex.insert(account.get());
+        _accountFilter.insert(accountNumber);
+        refreshFilter(_accountFilter, _accounts);
+        if (_rateLimiter.enabled()) {
+            _rateLimiter.addAccount(accountNumber, customerId);
+        }
+        journal("account", customerId, accountType, initialBalance, interestRate, overdraftLimit, currencyCode(currency));
+        log() << "Successfully created a " << accountType << " account for " << customer->getName()
+                  << " (ID: " << customerId << "). Account Number: " << accountNumber << endl;
+        return account;
+    }
+
+    // Retrieves an account by its number (DSA: Map lookup O(log N)).
+    shared_ptr<Account> getAccount(const string& accountNumber) const {
+        auto guard = sharedGuard();
+        if (_lookupFiltersEnabled && !_accountFilter.mayContain(accountNumber)) {
+            return nullptr; // Certainly unknown or closed: the map is not touched
+        }
+        auto it = _accounts.find(accountNumber);
+        if (it != _accounts.end()) {
+            return it->second;
+        }
+        return nullptr; // Account not found
+    }
+
+    // Looks up one live account through the hash index without taking a reference.
+    // (The hash index answers misses in about one probe, so it is not filtered.)
+    Account* findAccount(const string& accountNumber) const {
+        auto guard = sharedGuard();
+        return _accountIndex.find(accountNumber);
+    }
+
+    // The Bloom filters in front of account and customer lookups can be switched off
+    // (e.g. to compare lookup costs); they are kept up to date either way.
+    void setLookupFiltersEnabled(bool enabled) { _lookupFiltersEnabled = enabled; }
+
+    // Rebuilds both filters from the live maps now, so recently closed accounts and
+    // removed customers are rejected by the filter too (e.g. after end-of-day closures).
+    void compactLookupFilters() {
+        auto guard = exclusiveGuard();
+        refreshFilter(_accountFilter, _accounts, true);
+        refreshFilter(_customerFilter, _customers, true);
+    }
+    const BlockedBloomFilter& getAccountFilter() const { return _accountFilter; }
+    const BlockedBloomFilter& getCustomerFilter() const { return _customerFilter; }
+
+    // Resolves many account numbers at once through the hash index, overlapping their cache
+    // misses (see AccountIndex::findBatch). out[i] is the live account numbered
+    // accountNumbers[i], or nullptr. The pointers are owned by the bank and stay valid
+    // while the accounts remain open.
+    void findAccounts(const vector<string>& accountNumbers, vector<Account*>& out) const {
+        auto guard = sharedGuard();
+        out.resize(accountNumbers.size());
+        _accountIndex.findBatch(accountNumbers.size(),
+                                [&](size_t i) -> const string& { return accountNumbers[i]; }, out.data());
+    }
+
+    // Pre-sizes the account index for bulk account creation.
+    void reserveAccounts(size_t count) {
+        auto guard = exclusiveGuard();
+        _accountIndex.reserve(count);
+    }
+
+    // Returns a vector of all live accounts, ordered by account number.
+    vector<shared_ptr<Account>> getAllAccounts() const {
+        auto guard = sharedGuard();
+        vector<shared_ptr<Account>> allAccounts;
+        allAccounts.reserve(_accounts.size());
+        for (const auto& pair : _accounts) {
+            allAccounts.push_back(pair.second);
+        }
+        return allAccounts;
+    }
+
+    // Deposits into an account looked up by number.
+    bool deposit(const string& accountNumber, double amount) {
+        auto guard = sharedGuard();
+        auto timing = probe(BankOp::Deposit);
+        if (!admitRequest(accountNumber)) {
+            return false;
+        }
+        shared_ptr<Account> account = getAccount(accountNumber);
+        if (!account) {
+            log() << "Error: Account " << accountNumber << " not found." << endl;
+            return false;
+        }
+        auto accountLock = lockAccounts(*account);
+        if (!applyDeposit(*account, amount)) {
+            return false;
+        }
+        journal("deposit", accountNumber, amount);
+        return true;
+    }
+
+    // Withdraws from an account looked up by number.
+    bool withdraw(const string& accountNumber, double amount) {
+        auto guard = sharedGuard();
+        auto timing = probe(BankOp::Withdrawal);
+        if (!admitRequest(accountNumber)) {
+            return false;
+        }
+        shared_ptr<Account> account = getAccount(accountNumber);
+        if (!account) {
+            log() << "Error: Account " << accountNumber << " not found." << endl;
+            return false;
+        }
+        auto accountLock = lockAccounts(*account);
+        const uint64_t versionBefore = account->getVersion();
+        if (!applyWithdrawal(*account, amount)) {
+            journalSettlement(*account, versionBefore);
+            return false;
+        }
+        journal("withdraw", accountNumber, amount);
+        return true;
+    }
+
+    // Retrieves a closed account from the archive.
+    shared_ptr<Account> getArchivedAccount(const string& accountNumber) const {
+        auto guard = sharedGuard();
+        auto it = _archivedAccounts.find(accountNumber);
+        if (it != _archivedAccounts.end()) {
+            return it->second;
+        }
+        return nullptr; // Account not found
+    }
+
+    // Freezes an account so it rejects deposits, withdrawals and transfers.
+    bool freezeAccount(const string& accountNumber) {
+        auto guard = sharedGuard();
+        auto timing = probe(BankOp::Lifecycle);
+        shared_ptr<Account> account = getAccount(accountNumber);
+        if (!account) {
+            log() << "Error: Account " << accountNumber << " not found." << endl;
+            return false;
+        }
+        auto accountLock = lockAccounts(*account);
+        if (!applyFreeze(*account)) {
+            return false;
+        }
+        journal("freeze", accountNumber);
+        return true;
+    }
+
+    // Lifts a freeze placed with freezeAccount.
+    bool unfreezeAccount(const string& accountNumber) {
+        auto guard = sharedGuard();
+        auto timing = probe(BankOp::Lifecycle);
+        shared_ptr<Account> account = getAccount(accountNumber);
+        if (!account) {
+            log() << "Error: Account " << accountNumber << " not found." << endl;
+            return false;
+        }
+        auto accountLock = lockAccounts(*account);
+        if (!applyUnfreeze(*account)) {
+            return false;
+        }
+        journal("unfreeze", accountNumber);
+        return true;
+    }
+
+    // Closes a customer's account and moves it from the active index into the archive.
+    // The account must belong to the customer and have a zero balance.
+    bool closeAccount(const string& customerId, const string& accountNumber) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::Lifecycle);
+        shared_ptr<Customer> customer = getCustomer(customerId);
+        if (!customer) {
+            log() << "Error: Customer with ID " << customerId << " not found." << endl;
+            return false;
+        }
+        shared_ptr<Account> account = getAccount(accountNumber);
+        if (!account || !customer->ownsAccount(*account)) {
+            log() << "Error: Account " << accountNumber << " does not belong to customer "
+                      << customerId << "." << endl;
+            return false;
+        }
+        const uint64_t versionBefore = account->getVersion();
+        if (!applyClose(*account)) {
+            journalSettlement(*account, versionBefore);
+            return false;
+        }
+        _relations.unlinkAll(*account); // Every owner's, for a joint account
+        _accounts.erase(accountNumber); // DSA: Map erase O(log N)
+        _accountIndex.erase(accountNumber);
+        refreshFilter(_accountFilter, _accounts);
+        _rateLimiter.eraseAccount(accountNumber);
+        _archivedAccounts[accountNumber] = account;
+        journal("close", customerId, accountNumber);
+        return true;
+    }
+
+    // Removes a customer from the bank. All of the customer's accounts must be closed first.
+    bool removeCustomer(const string& customerId) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::Lifecycle);
+        auto it = _customers.find(customerId);
+        if (it == _customers.end()) {
+            log() << "Error: Customer with ID " << customerId << " not found." << endl;
+            return false;
+        }
+        if (it->second->getAccountCount() > 0) {
+            log() << "Cannot remove customer " << customerId << ": "
+                      << it->second->getAccountCount() << " account(s) still open." << endl;
+            return false;
+        }
+        _archivedCustomers[customerId] = it->second;
+        _customers.erase(it); // DSA: Map erase O(log N)
+        refreshFilter(_customerFilter, _customers);
+        _rateLimiter.eraseCustomer(customerId);
+        journal("remove", customerId);
+        log() << "Customer " << customerId << " has been removed." << endl;
+        return true;
+    }
+
+    // Adds a customer as a further owner of an open account (a joint account). Any owner
+    // may then close it, and it counts among each owner's accounts.
+    bool addJointOwner(const string& accountNumber, const string& customerId) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::Lifecycle);
+        shared_ptr<Customer> customer = getCustomer(customerId);
+        if (!customer) {
+            log() << "Error: Customer with ID " << customerId << " not found." << endl;
+            return false;
+        }
+        shared_ptr<Account> account = getAccount(accountNumber);
+        if (!account) {
+            log() << "Error: Account " << accountNumber << " not found." << endl;
+            return false;
+        }
+        if (!_relations.link(customer->getRelationSlot(), *account)) {
+            log() << "Customer " << customerId << " already owns account " << accountNumber << "." << endl;
+            return false;
+        }
+        journal("joint", accountNumber, customerId);
+        log() << "Customer " << customer->getName() << " added as a joint owner of account " << accountNumber
+              << "." << endl;
+        return true;
+    }
+
+    // Returns the IDs of an open account's owners, the customer who opened it first
+    // (DSA: one CSR row read). Empty if the account is not open.
+    vector<string> getAccountOwnerIds(const string& accountNumber) const {
+        auto guard = sharedGuard();
+        vector<string> owners;
+        if (const Account* account = findAccount(accountNumber)) {
+            for (uint32_t slot : _relations.ownersOf(*account)) {
+                owners.push_back(_relations.customerAt(slot)->getCustomerId());
+            }
+        }
+        return owners;
+    }
+
+    // Read access to the ownership index, e.g. for enumerating without copying.
+    const RelationshipIndex& getRelations() const { return _relations; }
+
+    // Traces where money leaving an account went: every account reachable through at most
+    // `hops` transfers (up to 255) dated within [fromDate, toDate], nearest first. Expands
+    // each hop on the worker pool, if one is set.
+    vector<FlowHop> traceFunds(const string& accountNumber, unsigned hops, time_t fromDate, time_t toDate) {
+        auto guard = exclusiveGuard(); // Traces reuse the graph's visit state, and transfers append to it
+        vector<FlowHop> reached;
+        shared_ptr<Account> account = getAccount(accountNumber);
+        if (!account) {
+            account = getArchivedAccount(accountNumber);
+        }
+        if (!account) {
+            log() << "Error: Account " << accountNumber << " not found." << endl;
+            return reached;
+        }
+        FlowTrace trace = _transfers.trace(account->getRelationSlot(), hops, fromDate, toDate, _pool.get());
+        reached.reserve(trace.accounts.size());
+        for (size_t i = 0; i < trace.accounts.size(); ++i) {
+            const Account* target = _relations.accountAt(trace.accounts[i]);
+            const TransferEdge* edge = _transfers.transfer(trace.via[i]);
+            reached.push_back({target->getAccountNumber(), trace.hops[i], trace.via[i],
+                               target->getTransactionHistory()[edge->toLeg].amount});
+        }
+        return reached;
+    }
+
+    // Every completed transfer; a transfer's ID indexes it here.
+    const TransferGraph& getTransferGraph() const { return _transfers; }
+
+    // Reserves room in the transfer log, e.g. before a known volume of transfers.
+    void reserveTransfers(size_t count) { _transfers.reserve(count); }
+
+    // Transfers funds between two accounts.
+    bool transferFunds(const string& fromAccountNum, const string& toAccountNum, double amount) {
+        auto guard = sharedGuard();
+        auto timing = probe(BankOp::Transfer);
+        if (!admitRequest(fromAccountNum)) {
+            return false;
+        }
+        shared_ptr<Account> fromAccount = getAccount(fromAccountNum);
+        shared_ptr<Account> toAccount = getAccount(toAccountNum);
+
+        if (!fromAccount) {
+            log() << "Error: Source account " << fromAccountNum << " not found." << endl;
+            return false;
+        }
+        if (!toAccount) {
+            log() << "Error: Destination account " << toAccountNum << " not found." << endl;
+            return false;
+        }
+        if (fromAccountNum == toAccountNum) {
+            log() << "Error: Cannot transfer to the same account." << endl;
+            return false;
+        }
+        if (amount <= 0) {
+            log() << "Transfer amount must be a positive number." << endl;
+            return false;
+        }
+
+        // The amount is in the source account's currency; convert it for the destination.
+        double creditAmount = amount;
+        if (fromAccount->getCurrency() != toAccount->getCurrency()) {
+            double rate = _fxRates.snapshot()->rate(fromAccount->getCurrency(), toAccount->getCurrency());
+            if (rate <= 0) {
+                log() << "Error: No exchange rate between " << currencyCode(fromAccount->getCurrency())
+                          << " and " << currencyCode(toAccount->getCurrency()) << "." << endl;
+                return false;
+            }
+            creditAmount = amount * rate;
+        }
+        auto accountLocks = lockAccounts(*fromAccount, *toAccount);
+        return completeTransfer(*fromAccount, *toAccount, amount, creditAmount);
+    }
+
+    // Applies a batch of transfers in submission order and returns how many succeeded.
+    // Every item converts at the same rates snapshot; the conversions are computed up front
+    // in one vectorized pass over contiguous arrays instead of one lookup per transfer.
+    size_t transferBatch(const vector<TransferRequest>& batch) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::Batch);
+        vector<uint8_t> admitted = admitBatch(batch);
+        PreparedBatch prepared = prepareBatch(batch);
+        size_t succeeded = 0;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (admitted[i] && checkBatchItem(prepared, batch[i], i, true)
+                && completeTransfer(*prepared.source(i), *prepared.destination(i), batch[i].amount, prepared.credits[i])) {
+                ++succeeded;
+            }
+        }
+        return succeeded;
+    }
+
+    // Applies a batch with the same result as transferBatch (every balance and history
+    // entry equal to applying the transfers one by one in submission order), but runs
+    // transfers that touch disjoint accounts in parallel on the worker pool.
+    // Scheduling: each valid transfer is placed in wave 1 + the latest wave of either of its
+    // accounts. Transfers in one wave share no account, so they need no locks, and every
+    // account still sees its transfers in submission order. Waves run one after another.
+    // Outcomes are reported in submission order once the batch is done.
+    size_t transferBatchParallel(const vector<TransferRequest>& batch) {
+        auto guard = exclusiveGuard();
+        auto timing = probe(BankOp::Batch);
+        const size_t count = batch.size();
+        vector<uint8_t> admitted = admitBatch(batch);
+        PreparedBatch prepared = prepareBatch(batch);
+
+        // Plan: greedy wave coloring of the conflict graph in submission order.
+        vector<uint32_t> waveOf(count, 0); // 0 = rejected before execution
+        unordered_map<const Account*, uint32_t> latestWave; // DSA: Hash map, account -> last wave
+        latestWave.reserve(2 * count);
+        uint32_t waves = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (!admitted[i] || !checkBatchItem(prepared, batch[i], i, false)) {
+                continue;
+            }
+            uint32_t& fromWave = latestWave[prepared.source(i)];
+            uint32_t& toWave = latestWave[prepared.destination(i)];
+            waveOf[i] = max(fromWave, toWave) + 1;
+            fromWave = toWave = waveOf[i];
+            waves = max(waves, waveOf[i]);
+        }
+        // DSA: Counting sort of the transfers by wave, keeping submission order within a wave.
+        vector<size_t> waveStart(waves + 2, 0), order(count);
+        for (size_t i = 0; i < count; ++i) {
+            ++waveStart[waveOf[i] + 1];
+        }
+        for (size_t w = 1; w < waveStart.size(); ++w) {
+            waveStart[w] += waveStart[w - 1];
+        }
+        vector<size_t> next(waveStart.begin(), waveStart.end() - 1);
+        for (size_t i = 0; i < count; ++i) {
+            order[next[waveOf[i]]++] = i;
+        }
+
+        // Execute the waves; wave 0 holds the rejected items and is skipped.
+        vector<OpStatus> outcome(count, OpStatus::Ok);
+        vector<pair<uint32_t, uint32_t>> legs(count); // History positions of each transfer's legs
+        // Whether a rejected item still posted to its source (settled interest). Decided in
+        // the wave, since later waves may post to the same source.
+        vector<uint8_t> settled(count, 0);
+        JobStats total;
+        total.name = "transfer waves";
+        for (uint32_t w = 1; w <= waves; ++w) {
+            const size_t* items = order.data() + waveStart[w];
+            JobStats stats = executeJob(total.name, waveStart[w + 1] - waveStart[w], 256, [&](size_t begin, size_t end) {
+                for (size_t k = begin; k < end; ++k) {
+                    size_t i = items[k];
+                    const uint64_t versionBefore = prepared.source(i)->getVersion();
+                    outcome[i] = postTransfer(*prepared.source(i), *prepared.destination(i),
+                                              batch[i].amount, prepared.credits[i]);
+                    settled[i] = outcome[i] != OpStatus::Ok && prepared.source(i)->getVersion() != versionBefore;
+                    if (outcome[i] == OpStatus::Ok) {
+                        legs[i] = {static_cast<uint32_t>(prepared.source(i)->getTransactionHistory().size() - 1),
+                                   static_cast<uint32_t>(prepared.destination(i)->getTransactionHistory().size() - 1)};
+                    }
+                }
+            });
+            total.threads = stats.threads;
+            total.items += stats.items;
+            total.tasks += stats.tasks;
+            total.steals += stats.steals;
+            total.wallSeconds += stats.wallSeconds;
+            total.busySeconds += stats.busySeconds;
+        }
+        _jobStats.push_back(total);
+
+        size_t succeeded = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (waveOf[i] == 0) {
+                if (admitted[i]) { // Rate-limited items were reported when charged
+                    checkBatchItem(prepared, batch[i], i, true);
+                }
+            } else if (outcome[i] != OpStatus::Ok) {
+                if (settled[i]) { // As journalSettlement: only when the source changed
+                    journal("settle", batch[i].fromAccountNum);
+                }
+                log() << "Batch item " << i << " rejected: " << opStatusDescription(outcome[i]) << "." << endl;
+            } else {
+                reportTransfer(*prepared.source(i), *prepared.destination(i), batch[i].amount, prepared.credits[i]);
+                recordTransfer(*prepared.source(i), *prepared.destination(i), legs[i].first, legs[i].second);
+                journal("transfer", batch[i].fromAccountNum, batch[i].toAccountNum, batch[i].amount);
+                ++succeeded;
+            }
+        }
+        log() << "Applied " << succeeded << " of " << count << " transfer(s) in " << waves << " wave(s)." << endl;
+        return succeeded;
+    }
+
+    // Totals the balances of all live accounts in the given currency.
+    // Returns false if some balance is held in a currency with no exchange rate.
+    bool totalBalances(Currency reportCurrency, double& total) const {
+        auto guard = sharedGuard();
+        shared_ptr<const FxRateSnapshot> rates = _fxRates.snapshot();
+        if (!rates->hasRate(reportCurrency)) {
+            log() << "Error: No exchange rate for " << currencyCode(reportCurrency) << "." << endl;
+            return false;
+        }
+        vector<double> balances;
+        vector<uint8_t> currencies;
+        balances.reserve(_accounts.size());
+        currencies.reserve(_accounts.size());
+        for (const auto& pair : _accounts) {
+            if (!rates->hasRate(pair.second->getCurrency())) {
+                log() << "Error: No exchange rate for " << currencyCode(pair.second->getCurrency()) << "." << endl;
+                return false;
+            }
+            balances.push_back(pair.second->getBalance());
+            currencies.push_back(static_cast<uint8_t>(pair.second->getCurrency()));
+        }
+        total = fxTotalKernel(*rates, balances.data(), currencies.data(), balances.size(), reportCurrency);
+        return true;
+    }
+
+    // Accrues interest on every live savings account for the period using a compile-time
+    // interest policy. Balances and rates are gathered into contiguous arrays, the
+    // policy-specialized kernel runs over them, and the results are posted back.
+    // Returns the number of accounts credited.
+    // Runs on the worker pool when one is configured, one chunk of accounts per task.
+    template <class Policy>
+    size_t accrueInterest(Policy policy, const AccrualPeriod& period) {
+        auto guard = exclusiveGuard();
+        vector<SavingsAccount*> savings;
+        for (const auto& pair : _accounts) {
+            if (auto* account = dynamic_cast<SavingsAccount*>(pair.second.get())) {
+                savings.push_back(account);
+            }
+        }
+        const size_t count = savings.size();
+        vector<double> balances(count), rates(count), interest(count);
+        vector<uint8_t> credited(count, 0);
+        policy.prepare(period);
+        runJob("interest accrual", count, 4096, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                savings[i]->settleInterest(); // Post lazily accrued interest before the pass
+                balances[i] = savings[i]->getBalance();
+                rates[i] = savings[i]->getInterestRate();
+            }
+            accrueInterestKernel(policy, balances.data() + begin, rates.data() + begin,
+                                 interest.data() + begin, end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                credited[i] = savings[i]->creditInterest(interest[i]);
+                savings[i]->markAccruedThrough(period.endDay);
+            }
+        });
+        for (size_t i = 0; i < count; ++i) { // Report in account order, independent of scheduling
+            journal("interest", savings[i]->getAccountNumber(), interest[i], period.endDay);
+            if (credited[i]) {
+                log() << "Interest of $" << fixed << setprecision(2) << interest[i]
+                          << " applied to savings account " << savings[i]->getAccountNumber() << ". "
+                          << "New balance: $" << savings[i]->getBalance() << endl;
+            }
+        }
+        return count;
+    }
+
+    // Checks every live account's history for consistency (see isHistoryConsistent) and
+    // reports the ones that fail. Returns the number of failing accounts.
+    size_t reconcileAccounts() {
+        auto guard = exclusiveGuard();
+        vector<shared_ptr<Account>> accounts = getAllAccounts();
+        vector<uint8_t> failed(accounts.size(), 0);
+        runJob("reconciliation", accounts.size(), 1024, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                failed[i] = !accounts[i]->isHistoryConsistent();
+            }
+        });
+        size_t failures = 0;
+        for (size_t i = 0; i < accounts.size(); ++i) {
+            if (failed[i]) {
+                log() << "Reconciliation failed for account " << accounts[i]->getAccountNumber() << "." << endl;
+                ++failures;
+            }
+        }
+        log() << "Reconciled " << accounts.size() << " account(s): " << failures << " mismatch(es)." << endl;
+        return failures;
+    }
+
+    // Writes a statement for every live account to `out`, in account-number order.
+    // Statements are formatted in parallel into per-account buffers, then written in order.
+    void generateStatements(ostream& out) {
+        auto guard = exclusiveGuard();
+        vector<shared_ptr<Account>> accounts = getAllAccounts();
+        vector<string> statements(accounts.size());
+        vector<uint64_t> versionsBefore(accounts.size());
+        for (size_t i = 0; i < accounts.size(); ++i) {
+            versionsBefore[i] = accounts[i]->getVersion();
+        }
+        runJob("statements", accounts.size(), 256, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                ostringstream text;
+                accounts[i]->settleInterest();
+                writeStatement(text, *accounts[i]);
+                statements[i] = text.str();
+            }
+        });
+        for (size_t i = 0; i < accounts.size(); ++i) {
+            journalSettlement(*accounts[i], versionsBefore[i]); // Interest the statement posted
+        }
+        for (const string& statement : statements) {
+            out << statement;
+        }
+    }
+
+    // Exports every live account as CSV:
+    // account_number,type,owner,currency,balance,status
+    void exportAccounts(ostream& out) {
+        auto guard = exclusiveGuard();
+        vector<shared_ptr<Account>> accounts = getAllAccounts();
+        const size_t grain = 4096;
+        vector<string> chunks((accounts.size() + grain - 1) / grain);
+        runJob("export", chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                ostringstream text;
+                text << fixed << setprecision(2);
+                for (size_t i = c * grain; i < min(accounts.size(), (c + 1) * grain); ++i) {
+                    const Account& account = *accounts[i];
+                    text << account.getAccountNumber() << ',' << account.getTypeName() << ','
+                         << account.getOwnerName() << ',' << currencyCode(account.getCurrency()) << ','
+                         << account.getBalance() << ',' << accountStatusName(account.getStatus()) << '\n';
+                }
+                chunks[c] = text.str();
+            }
+        });
+        out << "account_number,type,owner,currency,balance,status\n";
+        for (const string& chunk : chunks) {
+            out << chunk;
+        }
+    }
+
+    // Imports accounts from CSV lines of the form customer_id,type,initial_balance[,currency].
+    // Lines are parsed in parallel; accounts are then opened in file order so generated
+    // account numbers do not depend on the thread count. Returns the number opened.
+    size_t importAccounts(istream& in) {
+        auto guard = exclusiveGuard();
+        struct ImportRecord {
+            string customerId;
+            string type;
+            double initialBalance = 0.0;
+            Currency currency = Currency::USD;
+            bool valid = false;
+        };
+        vector<string> lines;
+        for (string line; getline(in, line);) {
+            if (!line.empty() && line.rfind("customer_id", 0) != 0) { // Skip blanks and a header
+                lines.push_back(line);
+            }
+        }
+        vector<ImportRecord> records(lines.size());
+        runJob("import", lines.size(), 1024, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                stringstream fields(lines[i]);
+                string balance, currency;
+                ImportRecord& record = records[i];
+                if (!getline(fields, record.customerId, ',') || !getline(fields, record.type, ',')
+                    || !getline(fields, balance, ',')) {
+                    continue;
+                }
+                char* parsedEnd = nullptr;
+                record.initialBalance = strtod(balance.c_str(), &parsedEnd);
+                record.valid = parsedEnd != balance.c_str()
+                               && (!getline(fields, currency, ',') || parseCurrency(currency, record.currency));
+            }
+        });
+        size_t opened = 0;
+        for (size_t i = 0; i < records.size(); ++i) {
+            if (!records[i].valid) {
+                log() << "Import: skipping malformed line " << i + 1 << ": " << lines[i] << endl;
+                continue;
+            }
+            if (createAccount(records[i].customerId, records[i].type, records[i].initialBalance,
+                              0.01, 0.0, records[i].currency)) {
+                ++opened;
+            }
+        }
+        log() << "Imported " << opened << " of " << records.size() << " account(s)." << endl;
+        return opened;
+    }
+
+    // Replays journal records (see Journaled) through the public operations, so a bank
+    // started empty ends up with the journaled customers, accounts, IDs, balances and
+    // histories (timestamps aside). Returns the number of records applied; records that
+    // cannot be parsed or are rejected are reported and skipped.
+    size_t applyJournal(istream& in) {
+        auto guard = exclusiveGuard();
+        size_t applied = 0;
+        size_t lineNumber = 0;
+        vector<string> fields;
+        for (string line; getline(in, line);) {
+            ++lineNumber;
+            if (line.empty()) {
+                continue;
+            }
+            if (applyJournalLineLocked(line, fields)) {
+                ++applied;
+            } else {
+                log() << "Journal: record " << lineNumber << " not applied: " << line << endl;
+            }
+        }
+        return applied;
+    }
+
+    // Applies one journal record (a line without its newline), e.g. as a standby receives
+    // it from the primary. Returns false if it is malformed or the bank rejects it.
+    bool applyJournalLine(const string& line) {
+        auto guard = exclusiveGuard();
+        return applyJournalLineLocked(line, _journalFields);
+    }
+
+    // Journals a heartbeat stamped with steadyNanos() and flushes the journal. A standby
+    // applying the heartbeat knows it has caught up to that moment, so heartbeats sent at a
+    // steady rate measure its replication lag (see JournalFollower).
+    void journalHeartbeat() {
+        journal("heartbeat", steadyNanos());
+        flushJournal();
+    }
+
+    // Prints an account statement. Accrued interest is posted (and journaled) first so the
+    // history and closing balance are complete.
+    bool printStatement(const string& accountNumber) {
+        auto guard = sharedGuard();
+        shared_ptr<Account> account = getAccount(accountNumber);
+        if (!account) {
+            log() << "Error: Account " << accountNumber << " not found." << endl;
+            return false;
+        }
+        auto accountLock = lockAccounts(*account);
+        const uint64_t versionBefore = account->getVersion();
+        account->settleInterest();
+        journalSettlement(*account, versionBefore);
+        writeStatement(cout, *account);
+        return true;
+    }
+
+    // Displays details of all customers.
+    void displayAllCustomers() const {
+        auto guard = sharedGuard();
+        if (_customers.empty()) {
+            cout << "No customers in the bank yet." << endl;
+            return;
+        }
+        cout << "\n--- All Customers ---" << endl;
+        for (const auto& pair : _customers) {
+            pair.second->printDetails();
+            cout << endl;
+            for (const Account* account : pair.second->getAccounts()) {
+                cout << "  - ";
+                account->printDetails();
+                cout << endl;
+            }
+        }
+        cout << "---------------------\n" << endl;
+    }
+
+    // Displays details of all accounts.
+    void displayAllAccounts() const {
+        auto guard = sharedGuard();
+        if (_accounts.empty()) {
+            cout << "No accounts in the bank yet." << endl;
+            return;
+        }
+        cout << "\n--- All Accounts ---" << endl;
+        for (const auto& pair : _accounts) {
+            pair.second->printDetails();
+            cout << endl;
+        }
+        cout << "--------------------\n" << endl;
+    }
+};
+
+// The classic profile: single-threaded, in memory, uninstrumented, with console messages.
+using Bank = BasicBank<SingleThreaded, InMemory, NoInstrumentation, ConsoleLog>;
+
+#endif // BANK_H
@@ -0,0 +1,41 @@
+#include "replication.h"
+#include <cstring> // For memchr
+
+// --- Log Shipping ---
+
+JournalFollower::JournalFollower(const string& path) : _in(path, ios::binary), _chunk(1 << 16) {
+    if (!_in) {
+        throw runtime_error("Cannot open journal " + path + " to follow.");
+    }
+}
+
+void JournalFollower::readLines() {
+    _lines.clear();
+    for (;;) {
+        _in.read(_chunk.data(), static_cast<streamsize>(_chunk.size()));
+        streamsize got = _in.gcount();
+        if (got <= 0) {
+            break;
+        }
+        const char* begin = _chunk.data();
+        const char* end = begin + got;
+        for (const char* newline; (newline = static_cast<const char*>(memchr(begin, '\n', end - begin)));) {
+            _partial.append(begin, newline);
+            if (!_partial.empty()) {
+                _lines.push_back(move(_partial));
+            }
+            _partial.clear();
+            begin = newline + 1;
+        }
+        _partial.append(begin, end); // A record the primary has not finished writing yet
+    }
+    _in.clear(); // Clear end-of-file so the next poll sees what is appended meanwhile
+}
+
+void JournalFollower::noteHeartbeat(const string& line) {
+    static const string kPrefix = "heartbeat\t";
+    if (line.compare(0, kPrefix.size(), kPrefix) == 0) {
+        int64_t stamped = strtoll(line.c_str() + kPrefix.size(), nullptr, 10);
+        _lagSeconds.push_back(static_cast<double>(steadyNanos() - stamped) * 1e-9);
+    }
+}
@@ -0,0 +1,63 @@
+// Log shipping to a hot standby: a standby bank follows the primary's journal file and
+// applies each record as it is appended.
+#ifndef BANK_REPLICATION_H
+#define BANK_REPLICATION_H
+
+#include "bank.h"
+
+// --- Log Shipping ---
+// The primary is a Journaled bank writing to a file. A standby (another process, or a
+// thread) opens the same file with a JournalFollower and keeps polling it: every
+// complete line appended since the last poll is applied with applyJournalLine, in
+// order, so the standby goes through exactly the primary's accepted operations. Nothing
+// but the file is shared, so no external service is needed.
+//
+// The primary writes through a buffered stream, so it calls journalHeartbeat() at a
+// steady rate (e.g. every millisecond from a timer thread). That flushes the buffer,
+// which bounds how stale the file can be, and stamps a heartbeat record. When the
+// standby applies a heartbeat it has caught up to the moment it was stamped, so
+// now - stamp is its replication lag at that point.
+
+class JournalFollower {
+private:
+    ifstream _in;
+    string _partial;     // Bytes after the last complete line, completed by the next poll
+    vector<char> _chunk; // Read buffer
+    vector<string> _lines;
+    uint64_t _records = 0;
+    uint64_t _rejected = 0;
+    vector<double> _lagSeconds; // DSA: One sample per heartbeat applied
+
+    // Reads everything appended since the last call into _lines (complete lines only).
+    void readLines();
+
+    // Records a lag sample if the line is a heartbeat.
+    void noteHeartbeat(const string& line);
+
+public:
+    // Opens the journal file at `path`, which the primary must have created.
+    explicit JournalFollower(const string& path);
+
+    // Applies every complete record appended since the last poll. Returns how many there
+    // were (0 = the standby is caught up with the file).
+    template <class BankType>
+    size_t poll(BankType& bank) {
+        readLines();
+        for (const string& line : _lines) {
+            noteHeartbeat(line);
+            _rejected += !bank.applyJournalLine(line);
+        }
+        _records += _lines.size();
+        return _lines.size();
+    }
+
+    // Records read so far (applied or rejected), heartbeats included.
+    uint64_t getRecordCount() const { return _records; }
+    // Records the standby refused. The primary journals only accepted operations, so
+    // anything but 0 means the two have diverged.
+    uint64_t getRejectedCount() const { return _rejected; }
+    // Replication lag measured at each heartbeat, in seconds.
+    const vector<double>& getLagSamples() const { return _lagSeconds; }
+};
+
+#endif // BANK_REPLICATION_H
@@ -0,0 +1,271 @@
+#include "workload.h"
+
+// --- Workload Generation and Replay ---
+
+Workload generateWorkload(const WorkloadConfig& config) {
+    Workload workload;
+    workload.config = config;
+    mt19937_64 rng(config.seed);
+    lognormal_distribution<double> amountDist(8.5, 1.2); // Median around $50
+    auto randomCents = [&]() { return max<int64_t>(1, static_cast<int64_t>(amountDist(rng))); };
+
+    // Setup phase: customers, then their accounts with opening balances.
+    const uint32_t accounts = config.customers * config.accountsPerCustomer;
+    workload.ops.reserve(config.customers + accounts + config.operations);
+    for (uint32_t c = 0; c < config.customers; ++c) {
+        workload.ops.push_back({WorkloadOpType::AddCustomer, 0, 0, 0});
+    }
+    for (uint32_t a = 0; a < accounts; ++a) {
+        workload.ops.push_back({WorkloadOpType::OpenAccount, a / config.accountsPerCustomer, a % 2,
+                                randomCents() * 10});
+    }
+
+    // Hot accounts are Zipf-distributed ranks mapped through a seeded shuffle, so the
+    // hottest accounts are spread over the key space rather than being the oldest ones.
+    vector<uint32_t> rankToAccount(accounts);
+    for (uint32_t a = 0; a < accounts; ++a) {
+        rankToAccount[a] = a;
+    }
+    shuffle(rankToAccount.begin(), rankToAccount.end(), rng);
+    ZipfSampler zipf(accounts, config.zipfSkew);
+    uniform_real_distribution<double> mix(0.0, 1.0);
+    uint32_t openedAccounts = accounts;
+
+    for (uint64_t i = 0; i < config.operations; ++i) {
+        if (config.interestEvery && i > 0 && i % config.interestEvery == 0) {
+            workload.ops.push_back({WorkloadOpType::InterestRun, 1, 0, 0});
+        }
+        double roll = mix(rng);
+        uint32_t account = rankToAccount[zipf(rng)];
+        if (roll < config.depositShare) {
+            workload.ops.push_back({WorkloadOpType::Deposit, account, 0, randomCents()});
+        } else if (roll < config.depositShare + config.withdrawShare) {
+            workload.ops.push_back({WorkloadOpType::Withdraw, account, 0, randomCents()});
+        } else if (roll < config.depositShare + config.withdrawShare + config.transferShare) {
+            uint32_t target = rankToAccount[zipf(rng)];
+            if (target == account) {
+                target = (account + 1) % accounts;
+            }
+            workload.ops.push_back({WorkloadOpType::Transfer, account, target, randomCents()});
+        } else {
+            uint32_t customer = uniform_int_distribution<uint32_t>(0, config.customers - 1)(rng);
+            workload.ops.push_back({WorkloadOpType::OpenAccount, customer, openedAccounts++ % 2, randomCents()});
+        }
+    }
+    return workload;
+}
+
+void saveWorkload(ostream& out, const Workload& workload) {
+    const WorkloadConfig& c = workload.config;
+    out << "BANKWL 1\n" << c.seed << ' ' << c.customers << ' ' << c.accountsPerCustomer << ' '
+        << c.operations << ' ' << c.interestEvery << '\n' << workload.ops.size() << '\n';
+    for (const WorkloadOp& op : workload.ops) {
+        out << static_cast<int>(op.type) << ' ' << op.first << ' ' << op.second << ' ' << op.cents << '\n';
+    }
+}
+
+bool loadWorkload(istream& in, Workload& workload) {
+    string magic;
+    int version = 0;
+    size_t count = 0;
+    WorkloadConfig& c = workload.config;
+    if (!(in >> magic >> version) || magic != "BANKWL" || version != 1) {
+        cout << "Error: Not a workload file." << endl;
+        return false;
+    }
+    in >> c.seed >> c.customers >> c.accountsPerCustomer >> c.operations >> c.interestEvery >> count;
+    workload.ops.clear();
+    workload.ops.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        int type = 0;
+        WorkloadOp op{};
+        if (!(in >> type >> op.first >> op.second >> op.cents) || type > static_cast<int>(WorkloadOpType::InterestRun)) {
+            cout << "Error: Workload file is truncated or corrupt at operation " << i << "." << endl;
+            return false;
+        }
+        op.type = static_cast<WorkloadOpType>(type);
+        workload.ops.push_back(op);
+    }
+    return true;
+}
+
+// --- Deterministic Execution ---
+
+// A money operation with its accounts resolved and its position in the account FIFOs.
+struct SequencedOp {
+    static constexpr uint32_t kNone = numeric_limits<uint32_t>::max();
+
+    WorkloadOpType type;
+    Account* from;           // The account for deposits and withdrawals
+    Account* to;             // Transfer destination, else nullptr
+    double amount;
+    double creditAmount;     // Transfer amount in the destination's currency
+    uint32_t next[2];        // Next operation on `from` and on `to`
+    uint8_t predecessors;    // Earlier operations this one waits for
+};
+
+// Applies one sequenced operation through the non-printing core operations.
+OpStatus applySequenced(const SequencedOp& op) {
+    switch (op.type) {
+        case WorkloadOpType::Deposit:
+            return op.from->postDeposit(op.amount);
+        case WorkloadOpType::Withdraw:
+            return op.from->postWithdrawal(op.amount);
+        default:
+            return Bank::postTransfer(*op.from, *op.to, op.amount, op.creditAmount);
+    }
+}
+
+// Executes one epoch of sequenced operations, on the pool if there is one, and returns
+// how many succeeded. Without a pool the operations run in log order, which is one valid
+// order of the DAG. Completed transfers are then logged on the bank in log order.
+size_t executeSequenced(Bank& bank, const vector<SequencedOp>& ops, ThreadPool* pool, time_t logTime) {
+    const size_t count = ops.size();
+    vector<uint8_t> succeeded(count, 0);
+    vector<pair<uint32_t, uint32_t>> legs(count); // History positions of each transfer's legs
+    // Only the thread running operation i touches its accounts until its successors are released.
+    auto apply = [&](size_t i) {
+        succeeded[i] = applySequenced(ops[i]) == OpStatus::Ok;
+        if (succeeded[i] && ops[i].to) {
+            legs[i] = {static_cast<uint32_t>(ops[i].from->getTransactionHistory().size() - 1),
+                       static_cast<uint32_t>(ops[i].to->getTransactionHistory().size() - 1)};
+        }
+    };
+    if (!pool) {
+        for (size_t i = 0; i < count; ++i) {
+            apply(i);
+        }
+    } else {
+        unique_ptr<atomic<uint8_t>[]> waiting(new atomic<uint8_t>[count]);
+        for (size_t i = 0; i < count; ++i) {
+            waiting[i].store(ops[i].predecessors, memory_order_relaxed);
+        }
+        atomic<size_t> remaining{count};
+        // Runs an operation, then releases its successors: the first one that becomes
+        // ready continues on this thread (its account is already in cache), others are queued.
+        function<void(uint32_t)> run = [&](uint32_t i) {
+            time_t outer = tlsTransactionTime;
+            tlsTransactionTime = logTime;
+            while (i != SequencedOp::kNone) {
+                apply(i);
+                uint32_t continueWith = SequencedOp::kNone;
+                for (uint32_t successor : ops[i].next) {
+                    if (successor != SequencedOp::kNone && waiting[successor].fetch_sub(1) == 1) {
+                        if (continueWith == SequencedOp::kNone) {
+                            continueWith = successor;
+                        } else {
+                            pool->submit([&run, successor] { run(successor); });
+                        }
+                    }
+                }
+                remaining.fetch_sub(1); // The epoch may finish now; only locals are used below
+                i = continueWith;
+            }
+            tlsTransactionTime = outer;
+        };
+        for (uint32_t i = 0; i < count; ++i) {
+            if (ops[i].predecessors == 0) {
+                pool->submit([&run, i] { run(i); });
+            }
+        }
+        pool->helpUntil([&] { return remaining.load() == 0; });
+    }
+    size_t applied = 0;
+    for (size_t i = 0; i < count; ++i) {
+        applied += succeeded[i];
+        if (succeeded[i] && ops[i].to) {
+            bank.recordTransfer(*ops[i].from, *ops[i].to, legs[i].first, legs[i].second);
+        }
+    }
+    return applied;
+}
+
+ReplayResult replayWorkloadDeterministic(Bank& bank, const Workload& workload, time_t logTime) {
+    ReplayResult result;
+    vector<string> customerIds;
+    vector<Account*> accounts;
+    ThreadPool* pool = bank.getWorkerPool();
+    shared_ptr<const FxRateSnapshot> rates = bank.getFxRates().snapshot();
+    ScopedQuietOutput quiet;
+    time_t outer = tlsTransactionTime;
+    tlsTransactionTime = logTime;
+
+    result.seconds = timeSeconds([&] {
+        vector<SequencedOp> epoch;
+        unordered_map<const Account*, uint32_t> lastOp; // DSA: Hash map, tail of each account FIFO
+        // Appends `index` to an account's FIFO and returns whether it has to wait.
+        auto enqueue = [&](const Account* account, uint32_t index) -> uint8_t {
+            auto inserted = lastOp.emplace(account, index);
+            if (inserted.second) {
+                return 0;
+            }
+            SequencedOp& previous = epoch[inserted.first->second];
+            previous.next[previous.from == account ? 0 : 1] = index;
+            inserted.first->second = index;
+            return 1;
+        };
+        const vector<WorkloadOp>& ops = workload.ops;
+        size_t i = 0;
+        while (i < ops.size()) {
+            // Sequence up to the next barrier.
+            epoch.clear();
+            lastOp.clear();
+            for (; i < ops.size() && ops[i].type != WorkloadOpType::InterestRun; ++i) {
+                const WorkloadOp& op = ops[i];
+                if (op.type == WorkloadOpType::AddCustomer) {
+                    string n = to_string(customerIds.size());
+                    customerIds.push_back(bank.addCustomer("Customer " + n, n + " Replay St")->getCustomerId());
+                    ++result.applied;
+                    continue;
+                }
+                if (op.type == WorkloadOpType::OpenAccount) {
+                    shared_ptr<Account> account = op.first < customerIds.size()
+                        ? bank.createAccount(customerIds[op.first], op.second == 0 ? "savings" : "checking",
+                                             op.amount(), 0.02, 500.0)
+                        : nullptr;
+                    if (account) {
+                        accounts.push_back(account.get());
+                    }
+                    account ? ++result.applied : ++result.rejected;
+                    continue;
+                }
+                // Money operations on unknown accounts are rejected here, as in a serial replay.
+                bool isTransfer = op.type == WorkloadOpType::Transfer;
+                if (op.first >= accounts.size() || (isTransfer && (op.second >= accounts.size() || op.second == op.first))) {
+                    ++result.rejected;
+                    continue;
+                }
+                SequencedOp sequenced{op.type, accounts[op.first], isTransfer ? accounts[op.second] : nullptr,
+                                      op.amount(), op.amount(), {SequencedOp::kNone, SequencedOp::kNone}, 0};
+                if (isTransfer && sequenced.from->getCurrency() != sequenced.to->getCurrency()) {
+                    double rate = rates->rate(sequenced.from->getCurrency(), sequenced.to->getCurrency());
+                    if (rate <= 0) {
+                        ++result.rejected;
+                        continue;
+                    }
+                    sequenced.creditAmount = op.amount() * rate;
+                }
+                uint32_t index = static_cast<uint32_t>(epoch.size());
+                epoch.push_back(sequenced);
+                uint8_t waits = enqueue(sequenced.from, index);
+                if (isTransfer) {
+                    waits += enqueue(sequenced.to, index);
+                }
+                epoch.back().predecessors = waits;
+            }
+
+            size_t applied = executeSequenced(bank, epoch, pool, logTime);
+            result.applied += applied;
+            result.rejected += epoch.size() - applied;
+
+            if (i < ops.size()) { // The barrier itself
+                bank.advanceBusinessDays(static_cast<int>(ops[i].first));
+                ++result.applied;
+                ++i;
+            }
+        }
+    });
+    tlsTransactionTime = outer;
+    result.fingerprint = bankFingerprint(bank, true);
+    return result;
+}
@@ -0,0 +1,211 @@
+// Synthetic workloads for the bank: generation, recording, replay (serial and
+// deterministic parallel) and state fingerprints.
+#ifndef BANK_WORKLOAD_H
+#define BANK_WORKLOAD_H
+
+#include "bank.h"
+
+// --- Workload Generation and Replay ---
+// A workload is a recorded sequence of bank operations generated from a seed. Replaying
+// the same workload against a fresh Bank always performs the same operations in the same
+// order, so timings of different data-structure or concurrency choices can be compared
+// like for like, and the resulting state can be checked with bankFingerprint.
+
+// Silences cout for its lifetime (used by replays and benchmarks, where the per-operation
+// console messages would dominate the measurement).
+class ScopedQuietOutput {
+private:
+    // Stream buffer that discards everything written to it.
+    class NullBuffer : public streambuf {
+    protected:
+        int overflow(int c) override { return traits_type::not_eof(c); }
+        streamsize xsputn(const char*, streamsize count) override { return count; }
+    };
+
+    NullBuffer _null;
+    streambuf* _saved;
+
+public:
+    ScopedQuietOutput() : _saved(cout.rdbuf(&_null)) {}
+    ~ScopedQuietOutput() { cout.rdbuf(_saved); }
+    ScopedQuietOutput(const ScopedQuietOutput&) = delete;
+    ScopedQuietOutput& operator=(const ScopedQuietOutput&) = delete;
+};
+
+enum class WorkloadOpType : uint8_t { AddCustomer, OpenAccount, Deposit, Withdraw, Transfer, InterestRun };
+
+// One recorded operation. Customers and accounts are referred to by the order in which
+// the workload created them, so a replay does not depend on generated IDs. Amounts are
+// whole cents so they round-trip through the text format exactly.
+struct WorkloadOp {
+    WorkloadOpType type;
+    uint32_t first;   // Customer index (OpenAccount), account index, or days (InterestRun)
+    uint32_t second;  // Account type for OpenAccount (0 savings, 1 checking) or transfer target
+    int64_t cents;    // Amount in cents
+
+    double amount() const { return cents / 100.0; }
+};
+
+// Shape of a generated workload.
+struct WorkloadConfig {
+    uint64_t seed = 1;
+    uint32_t customers = 1000;
+    uint32_t accountsPerCustomer = 2;
+    uint64_t operations = 100000;
+    double zipfSkew = 0.99;      // 0 = uniform; ~1 = a few very hot accounts
+    double depositShare = 0.40;  // Remaining share after deposit/withdraw/transfer is account opening
+    double withdrawShare = 0.30;
+    double transferShare = 0.28;
+    uint64_t interestEvery = 10000; // Insert an interest run every N operations (0 = never)
+};
+
+struct Workload {
+    WorkloadConfig config;
+    vector<WorkloadOp> ops;
+};
+
+// DSA: Samples ranks 0..n-1 with probability proportional to 1/(rank+1)^skew using a
+// precomputed cumulative distribution and binary search (O(log n) per sample).
+class ZipfSampler {
+private:
+    vector<double> _cdf;
+
+public:
+    ZipfSampler(size_t n, double skew) : _cdf(n) {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += 1.0 / pow(static_cast<double>(i + 1), skew);
+            _cdf[i] = sum;
+        }
+        for (double& p : _cdf) {
+            p /= sum;
+        }
+    }
+
+    template <class Rng>
+    size_t operator()(Rng& rng) const {
+        double u = uniform_real_distribution<double>(0.0, 1.0)(rng);
+        size_t rank = static_cast<size_t>(upper_bound(_cdf.begin(), _cdf.end(), u) - _cdf.begin());
+        return min(rank, _cdf.size() - 1);
+    }
+};
+
+// Builds a workload from a config. The same config (including seed) always produces the
+// same operations.
+Workload generateWorkload(const WorkloadConfig& config);
+
+// Writes a workload in a line-oriented text format ("BANKWL 1" header, one op per line).
+void saveWorkload(ostream& out, const Workload& workload);
+
+// Reads a workload written by saveWorkload. Returns false on a malformed file.
+bool loadWorkload(istream& in, Workload& workload);
+
+// Hashes every live account's number, balance and full transaction sequence (FNV-1a).
+// Two banks that went through the same operations have the same fingerprint. Timestamps
+// are only included on request, since ordinary replays stamp postings with the clock.
+template <class BankType>
+uint64_t bankFingerprint(const BankType& bank, bool includeDates = false) {
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+    };
+    for (const auto& account : bank.getAllAccounts()) {
+        string number = account->getAccountNumber();
+        double balance = account->getBalance();
+        mix(number.data(), number.size());
+        mix(&balance, sizeof(balance));
+        for (const auto& t : account->getTransactionHistory()) {
+            mix(&t.type, sizeof(t.type));
+            mix(&t.amount, sizeof(t.amount));
+            mix(&t.newBalance, sizeof(t.newBalance));
+            if (includeDates) {
+                mix(&t.date, sizeof(t.date));
+            }
+        }
+    }
+    return hash;
+}
+
+// Outcome of a replay.
+struct ReplayResult {
+    uint64_t applied = 0;   // Operations the bank accepted
+    uint64_t rejected = 0;  // Operations the bank refused (e.g. insufficient funds)
+    double seconds = 0.0;
+    uint64_t fingerprint = 0;
+};
+
+// Applies a workload to a bank (of any profile) in order, with console output silenced.
+template <class BankType>
+ReplayResult replayWorkload(BankType& bank, const Workload& workload) {
+    ReplayResult result;
+    vector<string> customerIds;
+    vector<string> accountNumbers;
+    ScopedQuietOutput quiet;
+    result.seconds = timeSeconds([&] {
+        for (const WorkloadOp& op : workload.ops) {
+            bool ok = false;
+            switch (op.type) {
+                case WorkloadOpType::AddCustomer: {
+                    string n = to_string(customerIds.size());
+                    customerIds.push_back(bank.addCustomer("Customer " + n, n + " Replay St")->getCustomerId());
+                    ok = true;
+                    break;
+                }
+                case WorkloadOpType::OpenAccount: {
+                    shared_ptr<Account> account = op.first < customerIds.size()
+                        ? bank.createAccount(customerIds[op.first], op.second == 0 ? "savings" : "checking",
+                                             op.amount(), 0.02, 500.0)
+                        : nullptr;
+                    if (account) {
+                        accountNumbers.push_back(account->getAccountNumber());
+                        ok = true;
+                    }
+                    break;
+                }
+                case WorkloadOpType::Deposit:
+                    ok = op.first < accountNumbers.size() && bank.deposit(accountNumbers[op.first], op.amount());
+                    break;
+                case WorkloadOpType::Withdraw:
+                    ok = op.first < accountNumbers.size() && bank.withdraw(accountNumbers[op.first], op.amount());
+                    break;
+                case WorkloadOpType::Transfer:
+                    ok = op.first < accountNumbers.size() && op.second < accountNumbers.size()
+                         && bank.transferFunds(accountNumbers[op.first], accountNumbers[op.second], op.amount());
+                    break;
+                case WorkloadOpType::InterestRun:
+                    bank.advanceBusinessDays(static_cast<int>(op.first));
+                    ok = true;
+                    break;
+            }
+            ok ? ++result.applied : ++result.rejected;
+        }
+    });
+    result.fingerprint = bankFingerprint(bank);
+    return result;
+}
+
+// --- Deterministic Execution ---
+// Calvin-style replay for audits: the log is sequenced up front on one thread, then
+// executed in parallel with a result that never depends on the thread count or timing.
+//  - Sequencing resolves every operation's accounts and gives each account a FIFO of
+//    the operations touching it, in log order. An operation may run once it is at the
+//    head of every FIFO it is in, which is deterministic lock acquisition in sequence
+//    order expressed as a dependency DAG (edges run between consecutive operations on
+//    the same account, so each operation has at most two predecessors and two successors).
+//  - Customer and account creation run during sequencing, in log order, so generated
+//    IDs are the same as in a serial replay.
+//  - Interest runs move the business-day clock every account reads, so they are barriers:
+//    the log is executed in epochs between them.
+//  - Every posting is stamped with the sequencer's time instead of the wall clock.
+// Balances and full transaction sequences (timestamps included) are identical for any
+// worker count, and equal to replayWorkload apart from the timestamps.
+
+// Replays a workload in deterministic parallel mode on the bank's worker pool (see
+// configureWorkers), with console output silenced. `logTime` is when the log was
+// sequenced; every posting carries it, so replays of the same log on any day agree.
+ReplayResult replayWorkloadDeterministic(Bank& bank, const Workload& workload, time_t logTime);
+
+#endif // BANK_WORKLOAD_H
@@ -0,0 +1,96 @@
+#include <cstdlib> // For malloc/free
+#include <new>     // For bad_alloc
+
+#include "bank.h"
+#include "workload.h"
+
+// --- Allocation Tracking ---
+// This test binary replaces the global operator new with a thin wrapper around malloc
+// that counts allocations per thread, and uses the count to prove the library's hot
+// paths allocate nothing. The library and the other binaries keep the standard allocator.
+thread_local uint64_t tlsAllocationCount = 0;
+
+// Returns the number of heap allocations made by the calling thread so far.
+uint64_t threadAllocationCount() { return tlsAllocationCount; }
+
+void* operator new(size_t size) {
+    ++tlsAllocationCount;
+    if (void* memory = malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw bad_alloc();
+}
+
+// GCC cannot see that the replaced operator new above returns malloc'ed memory.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+
+// Over-aligned types (such as cache-line aligned accounts) come through these.
+void* operator new(size_t size, align_val_t alignment) {
+    ++tlsAllocationCount;
+    const size_t align = static_cast<size_t>(alignment);
+    if (void* memory = aligned_alloc(align, (max<size_t>(size, 1) + align - 1) / align * align)) {
+        return memory;
+    }
+    throw bad_alloc();
+}
+void operator delete(void* memory, align_val_t) noexcept { free(memory); }
+void operator delete(void* memory, size_t, align_val_t) noexcept { free(memory); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// --- Allocation Checks ---
+// Registered with ctest as `allocations`. Asserts that steady-state deposit, withdraw,
+// transferFunds and getBalance make no heap allocations. "Steady state" means the
+// accounts exist and their history (and the bank's transfer log) has capacity reserved,
+// as a long-running account's history does between growth steps. Returns non-zero if any check fails.
+
+// Runs fn() `calls` times and checks that the calling thread did not allocate.
+template <class Fn>
+bool expectNoAllocations(const string& name, int calls, Fn&& fn) {
+    fn(); // Warm up: first-call effects (lazy statics, locale caches) are not steady state
+    uint64_t before = threadAllocationCount();
+    for (int i = 0; i < calls; ++i) {
+        fn();
+    }
+    uint64_t allocations = threadAllocationCount() - before;
+    // Reported on cerr because cout is silenced while the checks run.
+    cerr << (allocations == 0 ? "PASS " : "FAIL ") << left << setw(30) << name << right
+         << allocations << " allocations over " << calls << " calls" << endl;
+    return allocations == 0;
+}
+
+int runAllocationChecks() {
+    const int calls = 10000;
+    Bank bank("Allocation Check Bank");
+    ScopedQuietOutput quiet; // Console messages are not part of the hot path being checked
+    shared_ptr<Customer> customer = bank.addCustomer("Allocation Tester", "1 Heap Lane");
+    shared_ptr<Account> savings = bank.createAccount(customer->getCustomerId(), "savings", 1000000.0);
+    shared_ptr<Account> checking = bank.createAccount(customer->getCustomerId(), "checking", 1000000.0, 0.0, 500.0);
+    savings->reserveHistory(10 * calls);
+    checking->reserveHistory(10 * calls);
+    bank.reserveTransfers(2 * calls);
+    const string& savingsNumber = savings->getAccountNumber();
+    const string& checkingNumber = checking->getAccountNumber();
+
+    bool ok = true;
+    ok &= expectNoAllocations("Account::deposit", calls, [&] { savings->deposit(1.0); });
+    ok &= expectNoAllocations("Account::withdraw (savings)", calls, [&] { savings->withdraw(1.0); });
+    ok &= expectNoAllocations("Account::withdraw (checking)", calls, [&] { checking->withdraw(1.0); });
+    ok &= expectNoAllocations("Bank::deposit", calls, [&] { bank.deposit(checkingNumber, 1.0); });
+    ok &= expectNoAllocations("Bank::withdraw", calls, [&] { bank.withdraw(savingsNumber, 1.0); });
+    ok &= expectNoAllocations("Bank::transferFunds", calls,
+                              [&] { bank.transferFunds(savingsNumber, checkingNumber, 1.0); });
+    volatile double sink = 0.0;
+    ok &= expectNoAllocations("Account::getBalance", calls, [&] { sink = sink + savings->getBalance(); });
+    ok &= expectNoAllocations("Bank::getAccount", calls,
+                              [&] { sink = sink + bank.getAccount(checkingNumber)->getBalance(); });
+    return ok ? 0 : 1;
+}
+
+int main() { return runAllocationChecks(); }
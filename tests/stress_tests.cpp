@@ -0,0 +1,311 @@
+// Multi-threaded stress tests for the bank library. Registered with ctest as `stress`.
+// Sizes are kept small enough to finish in seconds on a single core.
+#include "bank.h"
+#include "workload.h"
+#include "test_support.h"
+
+using ConcurrentBank = BasicBank<Concurrent, InMemory, NoInstrumentation, SilentLog>;
+
+// Threads hammer a shared concurrent bank with transfers, deposits and withdrawals.
+// Money is neither created nor lost, every history stays consistent, and every transfer
+// is logged once with legs that point at its withdrawal and deposit. Traces run meanwhile.
+TEST(concurrentBankConservesMoney) {
+    ConcurrentBank bank("Stress Bank");
+    const size_t accounts = 64;
+    vector<string> numbers;
+    string customerId = bank.addCustomer("Stress Tester", "1 Load St")->getCustomerId();
+    for (size_t i = 0; i < accounts; ++i) {
+        numbers.push_back(bank.createAccount(customerId, "checking", 1000.0)->getAccountNumber());
+    }
+    const size_t threads = 8;
+    const size_t opsPerThread = 20000;
+    vector<double> netDeposits(threads, 0.0);
+    vector<size_t> transfers(threads, 0);
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            mt19937_64 rng(t + 1);
+            for (size_t i = 0; i < opsPerThread; ++i) {
+                const string& a = numbers[rng() % accounts];
+                const string& b = numbers[rng() % accounts];
+                double amount = 1.0 + static_cast<double>(rng() % 5000) / 100.0;
+                switch (rng() % 4) {
+                    case 0:
+                        netDeposits[t] += bank.deposit(a, amount) ? amount : 0.0;
+                        if (t == 0 && i % 500 == 0) {
+                            bank.traceFunds(a, 3, 0, time(nullptr) + 1);
+                        }
+                        break;
+                    case 1:
+                        netDeposits[t] -= bank.withdraw(a, amount) ? amount : 0.0;
+                        break;
+                    default:
+                        if (a != b) {
+                            transfers[t] += bank.transferFunds(a, b, amount) ? 1 : 0;
+                        }
+                }
+            }
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    double expected = 1000.0 * accounts;
+    for (double net : netDeposits) {
+        expected += net;
+    }
+    double total = 0.0;
+    CHECK(bank.totalBalances(Currency::USD, total));
+    CHECK_AMOUNT(total, expected);
+    for (const auto& account : bank.getAllAccounts()) {
+        CHECK(account->isHistoryConsistent());
+        CHECK(account->getBalance() > -0.005);
+    }
+    size_t completed = 0;
+    for (size_t count : transfers) {
+        completed += count;
+    }
+    const TransferGraph& graph = bank.getTransferGraph();
+    CHECK(graph.edgeCount() == completed);
+    for (uint32_t id = 1; id <= graph.edgeCount(); ++id) {
+        const TransferEdge* edge = graph.transfer(id);
+        const Account* from = bank.getRelations().accountAt(edge->from);
+        const Account* to = bank.getRelations().accountAt(edge->to);
+        CHECK(from->getTransactionHistory()[edge->fromLeg].type == TransactionType::Withdrawal);
+        CHECK(to->getTransactionHistory()[edge->toLeg].type == TransactionType::Deposit);
+    }
+}
+
+// Lifecycle changes and account openings race with money movement on other threads.
+TEST(concurrentLifecycleAndOpenings) {
+    ConcurrentBank bank("Lifecycle Bank");
+    string customerId = bank.addCustomer("Lifecycle Tester", "2 Load St")->getCustomerId();
+    vector<string> numbers;
+    for (int i = 0; i < 16; ++i) {
+        numbers.push_back(bank.createAccount(customerId, "savings", 100.0)->getAccountNumber());
+    }
+    atomic<bool> stop{false};
+    thread mover([&] {
+        mt19937_64 rng(7);
+        while (!stop.load()) {
+            bank.transferFunds(numbers[rng() % 16], numbers[rng() % 16], 1.0);
+        }
+    });
+    thread freezer([&] {
+        for (int round = 0; round < 2000; ++round) {
+            bank.freezeAccount(numbers[round % 16]);
+            bank.unfreezeAccount(numbers[round % 16]);
+        }
+    });
+    for (int i = 0; i < 2000; ++i) {
+        CHECK(bank.createAccount(customerId, "checking", 1.0) != nullptr);
+    }
+    freezer.join();
+    stop.store(true);
+    mover.join();
+    CHECK(bank.getAllAccounts().size() == 2016);
+    double total = 0.0;
+    CHECK(bank.totalBalances(Currency::USD, total));
+    CHECK_AMOUNT(total, 16 * 100.0 + 2000 * 1.0);
+}
+
+// Threads race to take tokens from one account's bucket while new accounts are opened
+// (and the limiter's table grows). Exactly the burst is admitted, and no other account is
+// starved.
+TEST(rateLimitAdmitsExactlyTheBurst) {
+    ConcurrentBank bank("Limited Bank");
+    string customerId = bank.addCustomer("Flooder", "3 Load St")->getCustomerId();
+    string hot = bank.createAccount(customerId, "checking", 0.0)->getAccountNumber();
+    string quiet = bank.createAccount(bank.addCustomer("Bystander", "4 Load St")->getCustomerId(), "checking", 0.0)
+                       ->getAccountNumber();
+    CHECK(bank.configureRateLimits({0.001, 500.0}, {0.001, 1000.0})); // No refill within the test
+    const size_t threads = 8;
+    vector<size_t> admitted(threads, 0);
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                admitted[t] += bank.deposit(hot, 1.0) ? 1 : 0;
+            }
+        });
+    }
+    for (int i = 0; i < 200; ++i) {
+        CHECK(bank.createAccount(customerId, "savings", 0.0) != nullptr);
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    size_t total = 0;
+    for (size_t count : admitted) {
+        total += count;
+    }
+    CHECK(total == 500);
+    CHECK_AMOUNT(bank.getAccount(hot)->getBalance(), 500.0);
+    CHECK(bank.getRateLimiter().getRejectedCount() == threads * 2000 - 500);
+    CHECK(bank.deposit(quiet, 1.0));
+}
+
+// Hot accounts migrate between shards while routed deposits and transfers keep arriving.
+// Every request runs exactly once, after the ones routed before it on the same account,
+// and no money is created or lost.
+TEST(liveMigrationKeepsRequestsAndMoney) {
+    ShardRuntime shards(NumaTopology::detect(), 4);
+    ConcurrentBank bank("Migration Bank");
+    bank.attachShards(&shards);
+    string customerId = bank.addCustomer("Migration Tester", "3 Load St")->getCustomerId();
+    vector<string> numbers;
+    for (int i = 0; i < 32; ++i) {
+        numbers.push_back(bank.createAccount(customerId, "checking", 500.0)->getAccountNumber());
+    }
+    const size_t requests = 40000;
+    vector<uint32_t> lastSequence(numbers.size(), 0); // Per hot account, checked on its shard
+    atomic<size_t> executed{0};
+    atomic<size_t> outOfOrder{0};
+    atomic<size_t> deposits{0};
+    atomic<bool> stop{false};
+    thread migrator([&] {
+        for (size_t round = 0; !stop.load(); ++round) {
+            const string& number = numbers[round % 4];
+            bank.migrateAccount(number, (shards.shardFor(number) + 1) % shards.shardCount());
+        }
+    });
+    mt19937_64 rng(5);
+    vector<uint32_t> nextSequence(numbers.size(), 0);
+    for (size_t i = 0; i < requests; ++i) {
+        size_t a = rng() % 8; // Hot accounts 0-3 are the ones migrating
+        size_t b = rng() % numbers.size();
+        uint32_t sequence = ++nextSequence[a];
+        auto check = [&, a, sequence] {
+            outOfOrder += lastSequence[a] + 1 != sequence;
+            lastSequence[a] = sequence;
+            ++executed;
+        };
+        if (a == b) {
+            shards.route({numbers[a]}, [&, a, check] {
+                deposits += bank.deposit(numbers[a], 1.0);
+                check();
+            });
+        } else {
+            shards.route({numbers[a], numbers[b]}, [&, a, b, check] {
+                bank.transferFunds(numbers[a], numbers[b], 1.0);
+                check();
+            });
+        }
+    }
+    while (executed.load() < requests) {
+        this_thread::yield();
+    }
+    stop.store(true);
+    migrator.join();
+    shards.drain();
+    CHECK(outOfOrder.load() == 0);
+    CHECK(!shards.getMigrations().empty());
+    double total = 0.0;
+    CHECK(bank.totalBalances(Currency::USD, total));
+    CHECK_AMOUNT(total, 500.0 * numbers.size() + static_cast<double>(deposits.load()));
+    for (const auto& account : bank.getAllAccounts()) {
+        CHECK(account->isHistoryConsistent());
+    }
+}
+
+// A reader thread copies balances out of the shared table while the bank posts to the
+// same accounts. Every snapshot it gets is internally consistent.
+TEST(sharedBalanceReadsNeverTear) {
+    ConcurrentBank bank("Published Bank");
+    string customerId = bank.addCustomer("Seqlock Tester", "4 Load St")->getCustomerId();
+    vector<string> numbers;
+    for (int i = 0; i < 8; ++i) {
+        numbers.push_back(bank.createAccount(customerId, "checking", 100.0)->getAccountNumber());
+    }
+    SharedBalanceTable table("/bank-stress-" + to_string(getpid()), numbers.size());
+    CHECK(bank.publishBalances(&table));
+    atomic<bool> stop{false};
+    thread writer([&] {
+        mt19937_64 rng(9);
+        for (int i = 0; i < 100000; ++i) {
+            const string& a = numbers[rng() % numbers.size()];
+            const string& b = numbers[rng() % numbers.size()];
+            if (rng() % 2 == 0) {
+                bank.deposit(a, 0.25);
+            } else if (a != b) {
+                bank.transferFunds(a, b, 0.5);
+            }
+        }
+        stop.store(true);
+    });
+    SharedBalanceTable reader(table.getName());
+    size_t reads = 0, torn = 0;
+    uint64_t retries = 0;
+    vector<uint64_t> lastVersion(numbers.size(), 0);
+    while (!stop.load()) {
+        for (size_t i = 0; i < numbers.size(); ++i) {
+            BalanceSnapshot snapshot;
+            if (!reader.read(numbers[i], snapshot, &retries)) {
+                ++torn;
+                continue;
+            }
+            ++reads;
+            bool consistent = snapshot.version >= lastVersion[i] && numbers[i] == snapshot.accountNumber;
+            if (snapshot.recentCount > 0) {
+                consistent &= fabs(snapshot.recent[snapshot.recentCount - 1].newBalance - snapshot.balance) < 0.005;
+            }
+            torn += !consistent;
+            lastVersion[i] = snapshot.version;
+        }
+    }
+    writer.join();
+    CHECK(reads > 0);
+    CHECK(torn == 0);
+    for (const string& number : numbers) {
+        BalanceSnapshot snapshot;
+        CHECK(reader.read(number, snapshot));
+        CHECK_AMOUNT(snapshot.balance, bank.findAccount(number)->getBalance());
+    }
+}
+
+// parallelFor covers every index exactly once, job after job.
+TEST(threadPoolCoversEveryIndex) {
+    ThreadPool pool(4);
+    for (size_t round = 0; round < 50; ++round) {
+        const size_t count = 10000 + round * 37;
+        vector<atomic<uint8_t>> hits(count);
+        JobStats stats = pool.parallelFor("stress", count, 64, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                hits[i].fetch_add(1);
+            }
+        });
+        bool once = stats.items == count;
+        for (const auto& hit : hits) {
+            once &= hit.load() == 1;
+        }
+        CHECK(once);
+    }
+}
+
+// Deterministic replay gives the serial result, transfer log included, at any worker count.
+TEST(parallelExecutionMatchesSerial) {
+    WorkloadConfig config;
+    config.operations = 50000;
+    config.customers = 500;
+    Workload workload = generateWorkload(config);
+    const time_t logTime = time(nullptr);
+    Bank serial("Serial Bank");
+    const uint64_t expected = replayWorkload(serial, workload).fingerprint;
+    uint64_t expectedWithDates = 0;
+    for (size_t workers : {0, 1, 4}) {
+        Bank bank("Deterministic Bank");
+        {
+            ScopedQuietOutput quiet;
+            bank.configureWorkers(workers);
+        }
+        uint64_t withDates = replayWorkloadDeterministic(bank, workload, logTime).fingerprint;
+        if (workers == 0) {
+            expectedWithDates = withDates;
+        }
+        CHECK(withDates == expectedWithDates); // Timestamps included
+        CHECK(bankFingerprint(bank) == expected);
+        CHECK(bank.getTransferGraph().edgeCount() == serial.getTransferGraph().edgeCount());
+    }
+}
+
+int main() { return runTests(); }
@@ -0,0 +1,62 @@
+// Minimal test harness shared by the test binaries (no third-party framework needed).
+// TEST(name) { ... } registers a test; CHECK(condition) records a failure and carries on.
+// runTests() runs every registered test and returns the process exit code.
+#ifndef BANK_TEST_SUPPORT_H
+#define BANK_TEST_SUPPORT_H
+
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct TestCase {
+    std::string name;
+    std::function<void()> body;
+};
+
+inline std::vector<TestCase>& testRegistry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, std::function<void()> body) { testRegistry().push_back({name, body}); }
+};
+
+#define TEST(name)                                                   \
+    static void name();                                              \
+    static TestRegistrar name##Registrar(#name, name);               \
+    static void name()
+
+// Failures are reported on cerr, which stays visible while tests silence cout.
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            ++testFailures();                                                               \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #condition << std::endl; \
+        }                                                                                   \
+    } while (0)
+
+// Checks that two amounts agree to within a tenth of a cent.
+#define CHECK_AMOUNT(actual, expected) CHECK(std::fabs((actual) - (expected)) < 0.001)
+
+inline int runTests() {
+    int failedTests = 0;
+    for (const TestCase& test : testRegistry()) {
+        int before = testFailures();
+        test.body();
+        bool passed = testFailures() == before;
+        failedTests += !passed;
+        std::cerr << (passed ? "PASS " : "FAIL ") << test.name << std::endl;
+    }
+    std::cerr << testRegistry().size() - failedTests << " of " << testRegistry().size() << " tests passed" << std::endl;
+    return failedTests == 0 ? 0 : 1;
+}
+
+#endif // BANK_TEST_SUPPORT_H
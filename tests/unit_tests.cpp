@@ -0,0 +1,743 @@
+// Unit tests for the bank library. Registered with ctest as `unit`.
+#include "bank.h"
+#include "workload.h"
+#include "replication.h"
+#include "test_support.h"
+
+// The silent profile runs the same operations without console output.
+using SilentBank = BasicBank<SingleThreaded, InMemory, NoInstrumentation, SilentLog>;
+
+// --- Accounts ---
+
+TEST(accountDepositAndWithdraw) {
+    SavingsAccount account("ACC1", "Test Owner", 100.0);
+    CHECK(account.postDeposit(50.0) == OpStatus::Ok);
+    CHECK(account.postWithdrawal(30.0) == OpStatus::Ok);
+    CHECK(account.postWithdrawal(500.0) == OpStatus::InsufficientFunds);
+    CHECK(account.postDeposit(-1.0) == OpStatus::InvalidAmount);
+    CHECK_AMOUNT(account.getBalance(), 120.0);
+    CHECK(account.getTransactionHistory().size() == 2);
+    CHECK(account.isHistoryConsistent());
+}
+
+TEST(checkingOverdraftLimit) {
+    CheckingAccount account("ACC2", "Test Owner", 100.0, 200.0);
+    CHECK(account.postWithdrawal(250.0) == OpStatus::Ok);
+    CHECK_AMOUNT(account.getBalance(), -150.0);
+    CHECK(account.postWithdrawal(100.0) == OpStatus::OverdraftExceeded);
+    CHECK_AMOUNT(account.getAvailableBalance(), 50.0);
+}
+
+TEST(accountLifecycle) {
+    CheckingAccount account("ACC3", "Test Owner", 10.0);
+    CHECK(account.postFreeze() == OpStatus::Ok);
+    CHECK(account.postDeposit(5.0) == OpStatus::AccountInactive);
+    CHECK(account.postFreeze() == OpStatus::AccountInactive);
+    CHECK(account.postUnfreeze() == OpStatus::Ok);
+    CHECK(account.postClose() == OpStatus::BalanceNotZero);
+    CHECK(account.postWithdrawal(10.0) == OpStatus::Ok);
+    CHECK(account.postClose() == OpStatus::Ok);
+    CHECK(account.getStatus() == AccountStatus::Closed);
+    CHECK(account.postClose() == OpStatus::AccountInactive);
+}
+
+// Each posting stream keeps an exact running mean and variance through its warm-up, then
+// flags amounts more than k standard deviations from its exponentially weighted mean.
+TEST(accountFlagsAnomalousPostings) {
+    CheckingAccount account("ACC3", "Test Owner", 0.0, 1000.0);
+    for (int i = 1; i <= 10; ++i) {
+        CHECK(account.postDeposit(i) == OpStatus::Ok);
+    }
+    CHECK_AMOUNT(account.getDepositStats().mean, 5.5);
+    CHECK(fabs(account.getDepositStats().variance - 8.25) < 1e-4);
+    CHECK(account.postDeposit(5000.0) == OpStatus::Ok); // Still warming up
+    CHECK(account.getAnomalyCount() == 0);
+
+    CheckingAccount payroll("ACC4", "Test Owner", 0.0, 1000.0);
+    for (int week = 0; week < int(kAnomalyWindow); ++week) {
+        payroll.postDeposit(week % 2 ? 95.0 : 105.0);
+        payroll.postWithdrawal(40.0);
+    }
+    CHECK(payroll.postDeposit(110.0) == OpStatus::Ok && !payroll.getTransactionHistory().back().anomalous);
+    CHECK(payroll.postDeposit(400.0) == OpStatus::Ok && payroll.getTransactionHistory().back().anomalous);
+    CHECK(payroll.postWithdrawal(40.10) == OpStatus::Ok); // Identical amounts so far: the 1% floor applies
+    CHECK(!payroll.getTransactionHistory().back().anomalous);
+    CHECK(payroll.postWithdrawal(60.0) == OpStatus::Ok && payroll.getTransactionHistory().back().anomalous);
+    CHECK(payroll.getAnomalyCount() == 2);
+    CHECK(!payroll.setAnomalyThreshold(0.0) && payroll.getAnomalyThreshold() == kDefaultAnomalySigmas);
+    CHECK(payroll.setAnomalyThreshold(1000.0));
+    CHECK(payroll.postDeposit(5000.0) == OpStatus::Ok && !payroll.getTransactionHistory().back().anomalous);
+
+    // ACH items posted at a cutoff feed the same streams.
+    CheckingAccount ach("ACC5", "Test Owner", 0.0, 1000.0);
+    for (int week = 0; week < int(kAnomalyWindow); ++week) {
+        ach.postDeposit(week % 2 ? 95.0 : 105.0);
+        ach.postWithdrawal(40.0);
+    }
+    PendingItem items[] = {{&ach, 100.0}, {&ach, 900.0}, {&ach, -40.0}, {&ach, -400.0}};
+    uint8_t returned[4] = {};
+    CHECK(ach.postPendingItems(items, 4, returned) == 4);
+    const vector<Transaction>& history = ach.getTransactionHistory();
+    CHECK(!history[history.size() - 4].anomalous && history[history.size() - 3].anomalous);
+    CHECK(!history[history.size() - 2].anomalous && history.back().anomalous);
+    CHECK(ach.getAnomalyCount() == 2 && ach.getDepositStats().mean > 110.0f);
+}
+
+TEST(accountConstructorRejectsBadArguments) {
+    bool threw = false;
+    try {
+        CheckingAccount account("ACC4", "Test Owner", -1.0);
+    } catch (const invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+// --- Bank operations ---
+
+TEST(bankRateLimitsRequests) {
+    SilentBank bank("Limited Bank");
+    string alice = bank.addCustomer("Alice", "1 Test St")->getCustomerId();
+    string from = bank.createAccount(alice, "checking", 100.0)->getAccountNumber();
+    string to = bank.createAccount(alice, "savings", 0.0)->getAccountNumber();
+    CHECK(!bank.configureRateLimits({-1.0, 1.0}, {}));
+    CHECK(bank.configureRateLimits({0.001, 3.0}, {})); // Three requests, then one per 1000 s
+    CHECK(bank.deposit(from, 1.0) && bank.withdraw(from, 1.0) && bank.transferFunds(from, to, 5.0));
+    CHECK(!bank.deposit(from, 1.0));
+    CHECK(!bank.transferFunds(from, to, 1.0));
+    CHECK(bank.deposit(to, 1.0)); // Other accounts are unaffected
+    CHECK_AMOUNT(bank.getAccount(from)->getBalance(), 95.0);
+    CHECK(bank.getRateLimiter().getRejectedCount() == 2);
+
+    CHECK(bank.configureRateLimits({}, {0.001, 2.0})); // Two requests across all of a customer's accounts
+    string bob = bank.addCustomer("Bob", "2 Test St")->getCustomerId();
+    string bobs = bank.createAccount(bob, "checking", 0.0)->getAccountNumber();
+    CHECK(bank.deposit(from, 1.0) && bank.deposit(to, 1.0) && !bank.deposit(from, 1.0));
+    CHECK(bank.deposit(bobs, 1.0) && bank.deposit(bobs, 1.0) && !bank.deposit(bobs, 1.0));
+    CHECK(bank.configureRateLimits({}, {}) && bank.deposit(from, 1.0));
+
+    // Batch items, ACH items and card authorizations are charged too.
+    CHECK(bank.configureRateLimits({0.001, 2.0}, {}));
+    CHECK(bank.transferBatch({{from, to, 1.0}, {from, to, 1.0}, {from, to, 1.0}, {to, from, 1.0}}) == 3);
+    CHECK(bank.transferBatchParallel({{from, to, 1.0}, {to, from, 1.0}}) == 1);
+    CHECK(!bank.queueAchCredit(from, 1.0) && bank.queueAchCredit(bobs, 1.0));
+    CHECK(!bank.queueAchDebit(bobs, 0.0)); // Invalid amounts are rejected before charging a token
+    CHECK(bank.authorizeHold(bobs, 0.5) != 0 && bank.authorizeHold(bobs, 0.5) == 0);
+
+    // A joint account is charged to the customer who opened it, also after reconfiguring.
+    CHECK(bank.configureRateLimits({}, {}));
+    string joint = bank.createAccount(bob, "savings", 0.0)->getAccountNumber();
+    CHECK(bank.addJointOwner(joint, alice));
+    CHECK(bank.configureRateLimits({}, {0.001, 1.0}));
+    CHECK(bank.deposit(joint, 1.0));
+    CHECK(!bank.deposit(bobs, 1.0) && bank.deposit(from, 1.0));
+}
+
+TEST(bankTransfersAndLookups) {
+    SilentBank bank("Unit Bank");
+    string customerId = bank.addCustomer("Alice", "1 Test St")->getCustomerId();
+    string from = bank.createAccount(customerId, "checking", 500.0)->getAccountNumber();
+    string to = bank.createAccount(customerId, "savings", 0.0)->getAccountNumber();
+    CHECK(bank.transferFunds(from, to, 200.0));
+    CHECK(!bank.transferFunds(from, to, 1000.0));
+    CHECK(!bank.transferFunds(from, from, 1.0));
+    CHECK_AMOUNT(bank.getAccount(from)->getBalance(), 300.0);
+    CHECK_AMOUNT(bank.getAccount(to)->getBalance(), 200.0);
+    CHECK(bank.findAccount(to) == bank.getAccount(to).get());
+    CHECK(bank.getAccount("ACC999999999") == nullptr);
+    CHECK(bank.getCustomer("C999999") == nullptr);
+    CHECK(bank.createAccount(customerId, "brokerage") == nullptr);
+}
+
+TEST(bankCrossCurrencyTransfer) {
+    SilentBank bank("Unit Bank");
+    bank.setExchangeRate(Currency::EUR, 1.25);
+    string customerId = bank.addCustomer("Bob", "2 Test St")->getCustomerId();
+    string usd = bank.createAccount(customerId, "checking", 100.0)->getAccountNumber();
+    string eur = bank.createAccount(customerId, "checking", 0.0, 0.0, 0.0, Currency::EUR)->getAccountNumber();
+    CHECK(bank.transferFunds(usd, eur, 50.0));
+    CHECK_AMOUNT(bank.getAccount(eur)->getBalance(), 40.0);
+    double total = 0.0;
+    CHECK(bank.totalBalances(Currency::USD, total));
+    CHECK_AMOUNT(total, 100.0);
+    CHECK(!bank.transferFunds(usd, bank.createAccount(customerId, "checking", 0.0, 0.0, 0.0, Currency::JPY)
+                                       ->getAccountNumber(), 1.0)); // No JPY rate
+}
+
+TEST(bankCloseAndRemove) {
+    SilentBank bank("Unit Bank");
+    string customerId = bank.addCustomer("Carol", "3 Test St")->getCustomerId();
+    string number = bank.createAccount(customerId, "checking", 40.0)->getAccountNumber();
+    CHECK(!bank.closeAccount(customerId, number));
+    CHECK(!bank.removeCustomer(customerId));
+    CHECK(bank.withdraw(number, 40.0));
+    CHECK(bank.closeAccount(customerId, number));
+    CHECK(bank.getAccount(number) == nullptr);
+    CHECK(bank.getArchivedAccount(number) != nullptr);
+    CHECK(bank.removeCustomer(customerId));
+    CHECK(bank.getCustomer(customerId) == nullptr);
+}
+
+// A joint account appears under both owners, either may close it, and it then leaves
+// both. Owners are listed with the opening customer first.
+TEST(bankJointAccounts) {
+    SilentBank bank("Unit Bank");
+    string alice = bank.addCustomer("Alice", "1 Joint St")->getCustomerId();
+    string bob = bank.addCustomer("Bob", "1 Joint St")->getCustomerId();
+    string joint = bank.createAccount(alice, "savings", 0.0)->getAccountNumber();
+    string own = bank.createAccount(bob, "checking", 0.0)->getAccountNumber();
+    CHECK(bank.addJointOwner(joint, bob));
+    CHECK(!bank.addJointOwner(joint, bob));
+    CHECK(!bank.addJointOwner("ACC999999999", bob));
+    CHECK((bank.getAccountOwnerIds(joint) == vector<string>{alice, bob}));
+    CHECK((bank.getAccountOwnerIds(own) == vector<string>{bob}));
+    shared_ptr<Customer> bobCustomer = bank.getCustomer(bob);
+    vector<string> bobAccounts;
+    for (const Account* account : bobCustomer->getAccounts()) {
+        bobAccounts.push_back(account->getAccountNumber());
+    }
+    CHECK((bobAccounts == vector<string>{own, joint}));
+    CHECK(bobCustomer->getAccountNumbers() == bobAccounts);
+    CHECK(!bank.removeCustomer(alice));
+    CHECK(bank.closeAccount(bob, joint)); // Either owner may close
+    CHECK(bank.getCustomer(alice)->getAccountCount() == 0);
+    CHECK(bobCustomer->getAccountCount() == 1);
+    CHECK(bank.getAccountOwnerIds(joint).empty());
+    CHECK(bank.removeCustomer(alice));
+}
+
+// A customer kept after its bank is gone no longer reads the bank's ownership index.
+TEST(customerOutlivesItsBank) {
+    shared_ptr<Customer> kept;
+    shared_ptr<Account> account;
+    {
+        SilentBank bank("Short-Lived Bank");
+        kept = bank.addCustomer("Carol", "3 Test St");
+        account = bank.createAccount(kept->getCustomerId(), "checking", 10.0);
+        CHECK(kept->getAccountCount() == 1);
+    }
+    CHECK(kept->getAccountCount() == 0 && kept->getAccountNumbers().empty());
+    CHECK(!kept->ownsAccount(*account));
+}
+
+// Random appends and removals on the slack CSR match a vector-per-row model, through
+// row relocations and compactions.
+TEST(slackCsrMatchesModel) {
+    SlackCsr<uint32_t> csr;
+    vector<vector<uint32_t>> model(200);
+    for (size_t i = 0; i < model.size(); ++i) {
+        csr.addRow();
+    }
+    mt19937_64 rng(3);
+    for (uint32_t step = 0; step < 50000; ++step) {
+        uint32_t row = static_cast<uint32_t>(rng() % model.size());
+        if (rng() % 3 == 0 && !model[row].empty()) {
+            uint32_t value = model[row][rng() % model[row].size()];
+            CHECK(csr.remove(row, value));
+            model[row].erase(find(model[row].begin(), model[row].end(), value));
+        } else {
+            csr.append(row, step);
+            model[row].push_back(step);
+        }
+    }
+    size_t edges = 0;
+    for (uint32_t row = 0; row < model.size(); ++row) {
+        CsrRange<uint32_t> values = csr.row(row);
+        CHECK(vector<uint32_t>(values.begin(), values.end()) == model[row]);
+        edges += model[row].size();
+    }
+    CHECK(csr.edgeCount() == edges);
+    CHECK(!csr.remove(0, 999999));
+}
+
+TEST(bankBatchMatchesSerialTransfers) {
+    SilentBank serial("Serial"), batched("Batched");
+    vector<string> numbers;
+    for (SilentBank* bank : {&serial, &batched}) {
+        string customerId = bank->addCustomer("Dana", "4 Test St")->getCustomerId();
+        numbers.clear();
+        for (int i = 0; i < 4; ++i) {
+            numbers.push_back(bank->createAccount(customerId, "checking", 100.0)->getAccountNumber());
+        }
+    }
+    vector<Bank::TransferRequest> batch = {
+        {numbers[0], numbers[1], 60.0}, {numbers[1], numbers[2], 150.0},
+        {numbers[0], numbers[3], 60.0}, {numbers[2], numbers[0], 10.0}};
+    for (const auto& request : batch) {
+        serial.transferFunds(request.fromAccountNum, request.toAccountNum, request.amount);
+    }
+    CHECK(batched.transferBatchParallel(batch) == 3);
+    CHECK(bankFingerprint(serial) == bankFingerprint(batched));
+    const TransferGraph& serialGraph = serial.getTransferGraph();
+    const TransferGraph& batchedGraph = batched.getTransferGraph();
+    CHECK(serialGraph.edgeCount() == 3 && batchedGraph.edgeCount() == 3);
+    for (uint32_t id = 1; id <= 3; ++id) {
+        const TransferEdge* a = serialGraph.transfer(id);
+        const TransferEdge* b = batchedGraph.transfer(id);
+        CHECK(a->from == b->from && a->to == b->to && a->fromLeg == b->fromLeg && a->toLeg == b->toLeg);
+    }
+}
+
+// A rejected batch item journals a settlement only if its source posted interest first.
+TEST(bankBatchJournalsOnlyRealSettlements) {
+    using JournaledBank = BasicBank<SingleThreaded, Journaled, NoInstrumentation, SilentLog>;
+    JournaledBank bank("Journaled");
+    stringstream journal;
+    bank.getPersistence().attachJournal(journal);
+    string customerId = bank.addCustomer("Erin", "5 Test St")->getCustomerId();
+    string checking = bank.createAccount(customerId, "checking", 100.0)->getAccountNumber();
+    string savings = bank.createAccount(customerId, "savings", 100.0, 0.05)->getAccountNumber();
+    CHECK(bank.transferBatchParallel({{checking, savings, 500.0}, {savings, checking, 10.0}}) == 1);
+    CHECK(journal.str().find("settle") == string::npos);
+    bank.advanceBusinessDays(30);
+    CHECK(bank.transferBatchParallel({{savings, checking, 500.0}}) == 0); // Interest posts, then it fails
+    string records = journal.str();
+    CHECK(records.find("settle") != string::npos && records.find("settle") == records.rfind("settle"));
+    SilentBank recovered("Recovered");
+    CHECK(recovered.applyJournal(journal) == bank.getPersistence().getJournalRecordCount());
+    CHECK(bankFingerprint(recovered) == bankFingerprint(bank));
+}
+
+// Transfers link their legs, and traces follow them hop by hop within the date range.
+TEST(bankTracesTransferFlows) {
+    SilentBank bank("Trace Bank");
+    string customerId = bank.addCustomer("Ivy", "9 Trace St")->getCustomerId();
+    vector<string> n;
+    for (int i = 0; i < 5; ++i) {
+        n.push_back(bank.createAccount(customerId, "checking", 100.0)->getAccountNumber());
+    }
+    const time_t day = 86400, start = 1700000000;
+    auto transferOn = [&](int d, int from, int to, double amount) {
+        tlsTransactionTime = start + d * day;
+        bool ok = bank.transferFunds(n[from], n[to], amount);
+        tlsTransactionTime = 0;
+        return ok;
+    };
+    CHECK(transferOn(1, 0, 1, 50.0) && transferOn(1, 0, 4, 10.0));
+    CHECK(transferOn(2, 1, 2, 20.0) && transferOn(3, 2, 3, 5.0) && transferOn(3, 3, 0, 1.0));
+    CHECK(!transferOn(3, 4, 0, 1000.0)); // Declined: no edge
+    const TransferGraph& graph = bank.getTransferGraph();
+    CHECK(graph.edgeCount() == 5);
+    const TransferEdge* first = graph.transfer(1);
+    const Transaction& debit = bank.getAccount(n[0])->getTransactionHistory()[first->fromLeg];
+    const Transaction& credit = bank.getAccount(n[1])->getTransactionHistory()[first->toLeg];
+    CHECK(debit.type == TransactionType::Withdrawal && credit.type == TransactionType::Deposit);
+    CHECK_AMOUNT(debit.amount, 50.0);
+    CHECK(first->date == start + day);
+
+    auto hopsTo = [&](const vector<FlowHop>& reached) {
+        map<string, unsigned> hops;
+        for (const FlowHop& hop : reached) {
+            hops[hop.accountNumber] = hop.hops;
+        }
+        return hops;
+    };
+    vector<FlowHop> oneHop = bank.traceFunds(n[0], 1, 0, start + 10 * day);
+    CHECK((hopsTo(oneHop) == map<string, unsigned>{{n[1], 1}, {n[4], 1}}));
+    CHECK(hopsTo(bank.traceFunds(n[0], 3, 0, start + 10 * day))
+          == (map<string, unsigned>{{n[1], 1}, {n[4], 1}, {n[2], 2}, {n[3], 3}}));
+    vector<FlowHop> late = bank.traceFunds(n[1], 5, start + 2 * day, start + 3 * day);
+    CHECK((hopsTo(late) == map<string, unsigned>{{n[2], 1}, {n[3], 2}, {n[0], 3}}));
+    CHECK(late[0].transferId == 3);
+    CHECK_AMOUNT(late[0].amount, 20.0);
+    CHECK(bank.traceFunds(n[0], 3, start + 2 * day, start + 3 * day).empty());
+    CHECK(bank.traceFunds("ACC999999999", 3, 0, start).empty());
+}
+
+// Parallel traces over an index plus a tail of unindexed edges match a plain BFS.
+TEST(transferGraphTraceMatchesReferenceBfs) {
+    const uint32_t accounts = 300;
+    mt19937 rng(11);
+    TransferGraph graph;
+    vector<TransferEdge> edges;
+    for (uint32_t i = 0; i < 4000; ++i) {
+        TransferEdge edge = {uint32_t(rng() % accounts), uint32_t(rng() % accounts), 0, 0, uint32_t(rng() % 100)};
+        edges.push_back(edge);
+        graph.record(edge);
+        if (i == 3500) {
+            graph.buildIndex(); // The last 499 edges stay in the tail
+        }
+    }
+    ThreadPool pool(3);
+    for (int query = 0; query < 60; ++query) {
+        uint32_t start = rng() % accounts;
+        unsigned hops = 1 + rng() % 4;
+        uint32_t low = rng() % 100, high = low + rng() % 40;
+        vector<int> expected(accounts, -1);
+        expected[start] = 0;
+        for (unsigned level = 1; level <= hops; ++level) {
+            for (const TransferEdge& edge : edges) {
+                if (edge.date >= low && edge.date <= high && expected[edge.from] == int(level) - 1
+                    && expected[edge.to] < 0) {
+                    expected[edge.to] = level;
+                }
+            }
+        }
+        FlowTrace trace = graph.trace(start, hops, low, high, query % 2 ? &pool : nullptr);
+        CHECK(graph.indexedCount() == 3501);
+        vector<int> actual(accounts, -1);
+        actual[start] = 0;
+        for (size_t i = 0; i < trace.accounts.size(); ++i) {
+            const TransferEdge* via = graph.transfer(trace.via[i]);
+            CHECK(via->to == trace.accounts[i] && via->date >= low && via->date <= high);
+            CHECK(actual[via->from] == trace.hops[i] - 1);
+            actual[trace.accounts[i]] = trace.hops[i];
+        }
+        CHECK(actual == expected);
+    }
+}
+
+// A migrated account keeps its state and identity and routes to its new shard.
+TEST(bankMigratesAccountBetweenShards) {
+    SilentBank bank("Shard Bank");
+    string customerId = bank.addCustomer("Dana", "4 Shard St")->getCustomerId();
+    string number = bank.createAccount(customerId, "checking", 100.0)->getAccountNumber();
+    CHECK(!bank.migrateAccount(number, 0)); // No shards attached
+    ShardRuntime shards(NumaTopology::detect(), 3);
+    bank.attachShards(&shards);
+    CHECK(bank.deposit(number, 25.0));
+    const Account* before = bank.findAccount(number);
+    size_t target = (shards.shardFor(number) + 1) % shards.shardCount();
+    MigrationStats stats;
+    CHECK(bank.migrateAccount(number, target, &stats));
+    CHECK(shards.shardFor(number) == target);
+    CHECK(stats.toShard == target && stats.fromShard != target);
+    CHECK(bank.findAccount(number) == before);
+    CHECK(before->getHomeNode() == shards.nodeOfShard(target));
+    CHECK_AMOUNT(before->getBalance(), 125.0);
+    CHECK(before->getTransactionHistory().size() == 1 && before->isHistoryConsistent());
+    CHECK(!bank.migrateAccount(number, target));          // Already there
+    CHECK(!bank.migrateAccount(number, 99));              // No such shard
+    CHECK(!bank.migrateAccount("ACC999999999", 0));       // No such account
+    CHECK(bank.migrateAccount(number, shards.homeShardFor(number)));
+    CHECK(shards.shardFor(number) == shards.homeShardFor(number));
+    CHECK(shards.getMigrations().size() == 2);
+}
+
+// A second, read-only mapping of the shared balance table sees every posting, status
+// change and new account, with the newest history entries oldest first.
+TEST(sharedBalanceTableMirrorsAccounts) {
+    SilentBank bank("Published Bank");
+    string customerId = bank.addCustomer("Erin", "5 Mirror St")->getCustomerId();
+    string number = bank.createAccount(customerId, "checking", 100.0)->getAccountNumber();
+    const string name = "/bank-unit-" + to_string(getpid());
+    SharedBalanceTable tooSmall(name + "-small", 0);
+    for (int i = 0; i < 60; ++i) {
+        bank.createAccount(customerId, "savings", 1.0);
+    }
+    CHECK(!bank.publishBalances(&tooSmall));
+    SharedBalanceTable table(name, 1000);
+    CHECK(bank.publishBalances(&table));
+    SharedBalanceTable reader(name);
+    BalanceSnapshot snapshot;
+    CHECK(reader.read(number, snapshot));
+    CHECK_AMOUNT(snapshot.balance, 100.0);
+    CHECK(snapshot.recentCount == 0 && snapshot.historySize == 0);
+    for (int i = 1; i <= 12; ++i) {
+        CHECK(bank.deposit(number, i));
+    }
+    CHECK(bank.freezeAccount(number));
+    CHECK(reader.read(number, snapshot));
+    const Account* account = bank.findAccount(number);
+    CHECK_AMOUNT(snapshot.balance, account->getBalance());
+    CHECK(snapshot.version == account->getVersion());
+    CHECK(snapshot.historySize == 12 && snapshot.recentCount == BalanceSnapshot::kPublishedHistory);
+    CHECK(snapshot.status == static_cast<uint32_t>(AccountStatus::Frozen));
+    for (size_t i = 0; i < snapshot.recentCount; ++i) {
+        CHECK_AMOUNT(snapshot.recent[i].amount, 5.0 + i);
+        CHECK_AMOUNT(snapshot.recent[i].newBalance, account->getTransactionHistory()[4 + i].newBalance);
+    }
+    string opened = bank.createAccount(customerId, "checking", 7.0)->getAccountNumber();
+    CHECK(reader.read(opened, snapshot));
+    CHECK_AMOUNT(snapshot.balance, 7.0);
+    CHECK(!reader.read("ACC999999999", snapshot));
+    CHECK(reader.size() == 62);
+    CHECK(bank.publishBalances(nullptr));
+}
+
+// --- Holds and ACH ---
+
+TEST(holdsCaptureReleaseAndExpire) {
+    SilentBank bank("Unit Bank");
+    string customerId = bank.addCustomer("Eve", "5 Test St")->getCustomerId();
+    string number = bank.createAccount(customerId, "checking", 100.0)->getAccountNumber();
+    uint64_t first = bank.authorizeHold(number, 60.0);
+    CHECK(first != 0);
+    CHECK(bank.authorizeHold(number, 60.0) == 0); // Only 40 available
+    CHECK(!bank.withdraw(number, 50.0));
+    CHECK(bank.captureHold(first, 45.0));
+    CHECK_AMOUNT(bank.getAccount(number)->getBalance(), 55.0);
+    uint64_t second = bank.authorizeHold(number, 20.0, 2);
+    uint64_t third = bank.authorizeHold(number, 10.0);
+    CHECK(bank.releaseHold(third));
+    CHECK(!bank.releaseHold(third));
+    bank.advanceBusinessDays(2);
+    CHECK(!bank.captureHold(second, 20.0)); // Expired
+    CHECK(bank.getOutstandingHoldCount() == 0);
+    CHECK_AMOUNT(bank.getAccount(number)->getAvailableBalance(), 55.0);
+}
+
+TEST(achCutoffPostsAndReturns) {
+    SilentBank bank("Unit Bank");
+    string customerId = bank.addCustomer("Frank", "6 Test St")->getCustomerId();
+    string number = bank.createAccount(customerId, "checking", 10.0)->getAccountNumber();
+    CHECK(bank.queueAchCredit(number, 100.0));
+    CHECK(bank.queueAchDebit(number, 500.0));
+    CHECK(bank.queueAchDebit(number, 30.0));
+    CHECK(!bank.queueAchCredit(number, 0.0) && !bank.queueAchDebit(number, -5.0));
+    CHECK(!bank.closeAccount(customerId, number)); // Items pending
+    CHECK(bank.runAchCutoff() == 2);
+    CHECK(bank.getPendingItemCount() == 0);
+    CHECK_AMOUNT(bank.getAccount(number)->getBalance(), 80.0);
+
+    Bank console("Console Bank"); // Invalid amounts are reported, not silently dropped
+    ostringstream captured;
+    streambuf* saved = cout.rdbuf(captured.rdbuf());
+    string consoleNumber = console.createAccount(console.addCustomer("Frank", "6 Test St")->getCustomerId(),
+                                                 "checking", 10.0)->getAccountNumber();
+    bool queued = console.queueAchDebit(consoleNumber, -5.0);
+    cout.rdbuf(saved);
+    CHECK(!queued && captured.str().find("ACH debit amount must be a positive number.") != string::npos);
+}
+
+// --- Interest and dates ---
+
+TEST(civilDayRoundTrip) {
+    for (int dayNumber : {-1000, 0, 59, 11016, 20000, 30000}) {
+        int year;
+        unsigned month, day;
+        civilFromDays(dayNumber, year, month, day);
+        CHECK(daysFromCivil(year, month, day) == dayNumber);
+    }
+    CHECK(daysFromCivil(2000, 3, 1) - daysFromCivil(2000, 2, 28) == 2); // Leap year
+}
+
+TEST(lazyInterestAccruesOnAdvance) {
+    SilentBank bank("Unit Bank");
+    string customerId = bank.addCustomer("Grace", "7 Test St")->getCustomerId();
+    string number = bank.createAccount(customerId, "savings", 10000.0, 0.05)->getAccountNumber();
+    bank.advanceBusinessDays(365);
+    double balance = bank.getAccount(number)->getBalance();
+    CHECK(balance > 10400.0 && balance < 10600.0);
+}
+
+// A savings account kept after its bank is gone still accrues up to the bank's last day.
+TEST(savingsAccountOutlivesItsBank) {
+    shared_ptr<Account> kept;
+    double expected = 0.0;
+    {
+        SilentBank bank("Short-Lived Bank");
+        string customerId = bank.addCustomer("Grace", "7 Test St")->getCustomerId();
+        kept = bank.createAccount(customerId, "savings", 10000.0, 0.05);
+        bank.advanceBusinessDays(365);
+        expected = 10000.0 + kept->getAccruedInterest();
+    }
+    CHECK(expected > 10400.0);
+    CHECK_AMOUNT(kept->getBalance(), expected);
+    CHECK_AMOUNT(kept->getBalance(), expected);
+}
+
+// --- Indexes and filters ---
+
+TEST(accountIndexFindAndErase) {
+    vector<unique_ptr<CheckingAccount>> accounts;
+    AccountIndex index;
+    for (int i = 0; i < 1000; ++i) {
+        accounts.push_back(make_unique<CheckingAccount>("ACC" + to_string(i), "Index Owner"));
+        index.insert(accounts.back().get());
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        CHECK(index.erase("ACC" + to_string(i)));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        CHECK((index.find("ACC" + to_string(i)) != nullptr) == (i % 2 == 1));
+    }
+    CHECK(index.size() == 500);
+}
+
+TEST(bloomFilterHasNoFalseNegatives) {
+    BlockedBloomFilter filter;
+    filter.reset(10000);
+    for (int i = 0; i < 10000; ++i) {
+        filter.insert("ACC" + to_string(i));
+    }
+    size_t falsePositives = 0;
+    for (int i = 0; i < 10000; ++i) {
+        CHECK(filter.mayContain("ACC" + to_string(i)));
+        falsePositives += filter.mayContain("MISS" + to_string(i));
+    }
+    CHECK(falsePositives < 100);
+}
+
+TEST(rateLimiterRefillsAndChargesCustomers) {
+    RateLimiter limiter;
+    limiter.configure({10.0, 3.0}, {10.0, 4.0}); // One request per 100 ms on each level
+    limiter.addCustomer("C1");
+    limiter.addAccount("ACC1", "C1");
+    limiter.addAccount("ACC2", "C1");
+    const int64_t ms = 1000000, start = 5000 * ms;
+    for (int i = 0; i < 3; ++i) {
+        CHECK(limiter.admit("ACC1", start));
+    }
+    CHECK(!limiter.admit("ACC1", start)); // The account's burst is spent
+    CHECK(limiter.admit("ACC2", start));  // The customer's fourth
+    for (int i = 0; i < 3; ++i) {
+        CHECK(!limiter.admit("ACC2", start)); // The customer's burst is spent; ACC2 is refunded
+    }
+    CHECK(limiter.admit("ACC9", start)); // Not registered
+    CHECK(limiter.getRejectedCount() == 4);
+    // 200 ms later the customer has two tokens back, and ACC2 was never charged for its
+    // rejected requests.
+    CHECK(limiter.admit("ACC2", start + 200 * ms) && limiter.admit("ACC2", start + 200 * ms));
+    CHECK(!limiter.admit("ACC2", start + 200 * ms));
+    CHECK(limiter.eraseAccount("ACC2") && !limiter.eraseAccount("ACC2") && limiter.accountCount() == 1);
+    CHECK(limiter.admit("ACC2", start + 200 * ms));
+    CHECK(limiter.eraseAccount("ACC1") && limiter.eraseCustomer("C1") && !limiter.eraseCustomer("C1"));
+    limiter.addCustomer("C2");
+    limiter.addAccount("ACC3", "C2"); // Reuses C1's bucket, full again
+    for (int i = 0; i < 3; ++i) {
+        CHECK(limiter.admit("ACC3", start + 200 * ms));
+    }
+    CHECK(limiter.customerCount() == 1);
+}
+
+// --- Workloads and journals ---
+
+TEST(workloadSaveLoadRoundTrip) {
+    WorkloadConfig config;
+    config.operations = 2000;
+    config.customers = 50;
+    Workload workload = generateWorkload(config);
+    stringstream file;
+    saveWorkload(file, workload);
+    Workload loaded;
+    CHECK(loadWorkload(file, loaded));
+    SilentBank original("Original"), reloaded("Reloaded");
+    CHECK(replayWorkload(original, workload).fingerprint == replayWorkload(reloaded, loaded).fingerprint);
+}
+
+// Transfers applied by a deterministic replay are logged as in a serial replay, so funds
+// can be traced through them.
+TEST(deterministicReplayRecordsTransfers) {
+    WorkloadConfig config;
+    config.operations = 5000;
+    config.customers = 100;
+    Workload workload = generateWorkload(config);
+    SilentBank serial("Serial");
+    replayWorkload(serial, workload);
+    Bank replayed("Deterministic");
+    replayWorkloadDeterministic(replayed, workload, time(nullptr));
+    CHECK(serial.getTransferGraph().edgeCount() > 0
+          && replayed.getTransferGraph().edgeCount() == serial.getTransferGraph().edgeCount());
+    const TransferEdge* first = replayed.getTransferGraph().transfer(1);
+    CHECK(first->from == serial.getTransferGraph().transfer(1)->from);
+    string start = replayed.getRelations().accountAt(first->from)->getAccountNumber();
+    auto reached = [&](vector<FlowHop> hops) {
+        vector<pair<string, unsigned>> accounts;
+        for (const FlowHop& hop : hops) {
+            accounts.emplace_back(hop.accountNumber, hop.hops);
+        }
+        sort(accounts.begin(), accounts.end());
+        return accounts;
+    };
+    vector<pair<string, unsigned>> traced = reached(replayed.traceFunds(start, 3, 0, time(nullptr) + 1));
+    CHECK(!traced.empty() && traced == reached(serial.traceFunds(start, 3, 0, time(nullptr) + 1)));
+}
+
+TEST(journalRecoveryReproducesState) {
+    using JournaledBank = BasicBank<SingleThreaded, Journaled, NoInstrumentation, SilentLog>;
+    JournaledBank primary("Primary");
+    stringstream journal;
+    primary.getPersistence().attachJournal(journal);
+    WorkloadConfig config;
+    config.operations = 5000;
+    config.customers = 100;
+    replayWorkload(primary, generateWorkload(config));
+    string customerId = primary.addCustomer("Heidi", "8 Test St")->getCustomerId();
+    string number = primary.createAccount(customerId, "checking", 100.0)->getAccountNumber();
+    uint64_t hold = primary.authorizeHold(number, 30.0);
+    primary.captureHold(hold, 20.0);
+    primary.queueAchDebit(number, 10.0);
+    primary.runAchCutoff();
+    primary.freezeAccount(number);
+    CHECK(!primary.setAnomalyThreshold(-1.0) && primary.setAnomalyThreshold(3.0));
+    primary.addJointOwner(number, primary.addCustomer("Judy", "8 Test St")->getCustomerId());
+
+    SilentBank recovered("Recovered");
+    recovered.configureRateLimits({0.001, 1.0}, {0.001, 1.0}); // Replayed records are not limited
+    CHECK(recovered.applyJournal(journal) == primary.getPersistence().getJournalRecordCount());
+    CHECK(bankFingerprint(recovered) == bankFingerprint(primary));
+    CHECK(recovered.getAccount(number)->getStatus() == AccountStatus::Frozen);
+    CHECK(recovered.getAccountOwnerIds(number) == primary.getAccountOwnerIds(number));
+    CHECK(recovered.getAnomalyThreshold() == 3.0);
+    CHECK(recovered.getAccount(number)->getAnomalyCount() == primary.getAccount(number)->getAnomalyCount());
+    CHECK(primary.getTransferGraph().edgeCount() > 0
+          && recovered.getTransferGraph().edgeCount() == primary.getTransferGraph().edgeCount());
+}
+
+// Interest a statement posts is journaled, so recovery rebuilds the same history.
+TEST(statementSettlementIsJournaled) {
+    using JournaledBank = BasicBank<SingleThreaded, Journaled, NoInstrumentation, SilentLog>;
+    JournaledBank primary("Primary");
+    stringstream journal;
+    primary.getPersistence().attachJournal(journal);
+    string customerId = primary.addCustomer("Frank", "6 Test St")->getCustomerId();
+    string number = primary.createAccount(customerId, "savings", 1000.0, 0.05)->getAccountNumber();
+    primary.advanceBusinessDays(30);
+    CHECK(primary.printStatement(number));
+    primary.advanceBusinessDays(30);
+    ostringstream statements;
+    primary.generateStatements(statements);
+    primary.advanceBusinessDays(30);
+    primary.deposit(number, 10.0);
+
+    SilentBank recovered("Recovered");
+    CHECK(recovered.applyJournal(journal) == primary.getPersistence().getJournalRecordCount());
+    CHECK(recovered.getAccount(number)->getTransactionHistory().size()
+          == primary.getAccount(number)->getTransactionHistory().size());
+    CHECK(bankFingerprint(recovered) == bankFingerprint(primary));
+}
+
+// A standby following the primary's journal file applies only complete records and ends
+// in the primary's state.
+TEST(standbyFollowsJournalFile) {
+    using JournaledBank = BasicBank<SingleThreaded, Journaled, NoInstrumentation, SilentLog>;
+    const string path = "standby-test-" + to_string(getpid()) + ".journal";
+    ofstream file(path, ios::trunc);
+    JournaledBank primary("Primary");
+    primary.getPersistence().attachJournal(file);
+    SilentBank standby("Standby");
+    JournalFollower follower(path);
+    WorkloadConfig config;
+    config.operations = 2000;
+    config.customers = 40;
+    replayWorkload(primary, generateWorkload(config));
+    primary.journalHeartbeat();
+    CHECK(follower.poll(standby) == primary.getPersistence().getJournalRecordCount());
+    CHECK(bankFingerprint(standby) == bankFingerprint(primary));
+    CHECK(follower.getLagSamples().size() == 1);
+
+    string number = primary.getAllAccounts().front()->getAccountNumber();
+    file << "deposit\t" << number << "\t12" << flush; // Record not finished yet
+    CHECK(follower.poll(standby) == 0);
+    file << ".5\n" << flush;
+    CHECK(follower.poll(standby) == 1);
+    CHECK(follower.getRejectedCount() == 0);
+    CHECK_AMOUNT(standby.getAccount(number)->getBalance(), primary.getAccount(number)->getBalance() + 12.5);
+    primary.getPersistence().detachJournal();
+    remove(path.c_str());
+}
+
+TEST(instrumentationCountsOperations) {
+    BasicBank<SingleThreaded, InMemory, OpCounters, SilentLog> bank("Counted");
+    string customerId = bank.addCustomer("Ivan", "9 Test St")->getCustomerId();
+    string number = bank.createAccount(customerId, "checking", 0.0)->getAccountNumber();
+    bank.deposit(number, 10.0);
+    bank.deposit(number, -1.0); // Rejected calls are counted too
+    bank.withdraw(number, 5.0);
+    CHECK(bank.getInstrumentation().getCallCount(BankOp::Deposit) == 2);
+    CHECK(bank.getInstrumentation().getCallCount(BankOp::Withdrawal) == 1);
+    CHECK(bank.getInstrumentation().getCallCount(BankOp::Transfer) == 0);
+}
+
+int main() { return runTests(); }